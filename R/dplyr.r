@@ -22,6 +22,19 @@
 #' \describe{
 #' \item{`dplyr.show_progress`}{Should lengthy operations such as `do()`
 #'   show a progress bar? Default: `TRUE`}
+#' \item{`dplyr.threads`}{Number of threads used to build the index of
+#'   large grouped data frames. Only has an effect if dplyr was compiled
+#'   with OpenMP support. Default: `1`}
+#' \item{`dplyr.ordered_groups`}{Should groups be sorted by the grouping
+#'   variables? If `FALSE`, they come in the order of their first appearance
+#'   in the data, which saves sorting them. Default: `TRUE`}
+#' \item{`dplyr.group_cache_size`}{Memory budget in bytes of the cache of
+#'   group indices. When positive, [group_by()] reuses the index built for the
+#'   same unchanged grouping columns. Default: `0`, no cache}
+#' \item{`dplyr.collation`}{How [arrange()], [group_by()] and the ranking
+#'   functions order strings. `"locale"` orders them as [sort()] does, in the
+#'   collation of the current locale. `"C"` orders them by their bytes, which
+#'   is faster. Default: `"locale"`}
 #' }
 #'
 #' @section Package configurations:
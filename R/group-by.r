@@ -25,6 +25,14 @@
 #' [group_by_at()]) make it easy to group a dataset by a selection of
 #' variables.
 #'
+#' @section Order of groups:
+#'
+#' Groups of a data frame are sorted by the grouping variables.
+#' `group_by()` has no argument to change that: to keep the groups in the
+#' order in which they first appear in the data, set
+#' `options(dplyr.ordered_groups = FALSE)` or call `grouped_df()` with
+#' `ordered = FALSE`, which are the only ways to get unordered groups.
+#'
 #' @param .data a tbl
 #' @param ... Variables to group by. All tbls accept variable names.
 #'   Some tbls will accept functions of variables. Duplicated groups
@@ -9,20 +9,26 @@
 #' @param vars a character vector or a list of [name()]
 #' @param drop if `TRUE` preserve all factor levels, even those without
 #'   data.
+#' @param ordered if `FALSE`, groups are kept in the order in which they
+#'   first appear in the data rather than sorted by the grouping variables,
+#'   which saves sorting the groups. Defaults to the `dplyr.ordered_groups`
+#'   option.
 #' @export
-grouped_df <- function(data, vars, drop = TRUE) {
+grouped_df <- function(data, vars, drop = TRUE,
+                       ordered = getOption("dplyr.ordered_groups", TRUE)) {
   if (length(vars) == 0) {
     return(tbl_df(data))
   }
   assert_that(
     is.data.frame(data),
     (is.list(vars) && all(sapply(vars,is.name))) || is.character(vars),
-    is.flag(drop)
+    is.flag(drop),
+    is.flag(ordered)
   )
   if (is.list(vars)) {
     vars <- deparse_names(vars)
   }
-  grouped_df_impl(data, unname(vars), drop)
+  grouped_df_impl(data, unname(vars), drop, ordered)
 }
 
 setOldClass(c("grouped_df", "tbl_df", "tbl", "data.frame"))
@@ -36,7 +42,7 @@ is_grouped_df <- is.grouped_df
 
 #' @export
 tbl_sum.grouped_df <- function(x) {
-  grps <- if (is.null(attr(x, "indices"))) "?" else length(attr(x, "indices"))
+  grps <- if (is.null(attr(x, "group_sizes"))) "?" else length(attr(x, "group_sizes"))
   c(
     NextMethod(),
     c("Groups" = paste0(commas(group_vars(x)), " [", big_mark(grps), "]"))
@@ -50,7 +56,7 @@ group_size.grouped_df <- function(x) {
 
 #' @export
 n_groups.grouped_df <- function(x) {
-  length(attr(x, "indices"))
+  length(attr(x, "group_sizes"))
 }
 
 #' @export
@@ -163,10 +169,11 @@ rename_.grouped_df <- function(.data, ..., .dots = list()) {
 #' @export
 do.grouped_df <- function(.data, ...) {
   # Force computation of indices
-  if (is_null(attr(.data, "indices"))) {
+  if (is_null(attr(.data, "indices")) || is_null(attr(.data, "group_rows"))) {
     .data <- grouped_df_impl(
       .data, attr(.data, "vars"),
-      attr(.data, "drop") %||% TRUE
+      attr(.data, "drop") %||% TRUE,
+      attr(.data, "ordered_groups") %||% TRUE
     )
   }
   index <- attr(.data, "indices")
@@ -38,10 +38,8 @@ id <- function(.variables, drop = FALSE) {
   ndistinct <- vapply(ids, attr, "n", FUN.VALUE = numeric(1), USE.NAMES = FALSE)
   n <- prod(ndistinct)
   if (n > 2 ^ 31) {
-    # Too big for integers, have to use strings, which will be much slower :(
-
-    char_id <- do.call("paste", c(ids, sep = "\r"))
-    res <- match(char_id, unique(char_id))
+    # Too big for integers, number the distinct combinations instead
+    res <- id_native(rev(ids))
   } else {
     combs <- c(1, cumprod(ndistinct[-p]))
 
@@ -65,10 +63,28 @@ id_var <- function(x, drop = FALSE) {
   if (is.factor(x) && !drop) {
     id <- as.integer(addNA(x, ifany = TRUE))
     n <- length(levels(x))
+  } else if (is_groupable(x)) {
+    id <- id_native(list(x))
+    n <- attr(id, "n")
   } else {
     levels <- sort(unique(x), na.last = TRUE)
     id <- match(x, levels)
     n <- max(id)
   }
-  structure(id, n = n)
+  structure(as.vector(id), n = n)
+}
+
+# Can x be numbered by group_ids_impl()? Other vectors, e.g. raw vectors, are
+# numbered with sort() and match()
+is_groupable <- function(x) {
+  typeof(x) %in% c("logical", "integer", "double", "character", "complex") && is.null(dim(x))
+}
+
+# Dense ids of the distinct rows of a list of vectors, numbered in sorted
+# order, computed with a single hashing pass
+id_native <- function(.variables) {
+  names(.variables) <- paste0("V", seq_along(.variables))
+  attr(.variables, "row.names") <- .set_row_names(length(.variables[[1]]))
+  class(.variables) <- "data.frame"
+  group_ids_impl(.variables, names(.variables), TRUE)
 }
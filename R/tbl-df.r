@@ -61,6 +61,18 @@ filter.tbl_df <- function(.data, ...) {
     return(.data)
   }
 
+  if (length(dots) == 1) {
+    out <- filter_key_index(.data, dots[[1]])
+    if (is.data.frame(out)) {
+      return(out)
+    }
+    out <- filter_top_n(.data, out)
+    if (is.data.frame(out)) {
+      return(out)
+    }
+    dots[[1]] <- out
+  }
+
   quo <- all_exprs(!!! dots, .vectorised = TRUE)
   filter_impl(.data, quo)
 }
@@ -111,6 +123,8 @@ summarise_.tbl_df <- function(.data, ..., .dots = list()) {
 #' functions.
 #'
 #' @inheritParams inner_join
+#' @inheritParams asof_join
+#' @inheritParams inequality_join
 #' @param ... included for compatibility with the generic; otherwise ignored.
 #' @param na_matches
 #'   Use `"never"` to always treat two `NA` or `NaN` values as
@@ -119,6 +133,14 @@ summarise_.tbl_df <- function(.data, ..., .dots = list()) {
 #'   The default,`"na"`, always treats two `NA` or `NaN` values as equal, like [merge()].
 #'   Users and package authors can change the default behavior by calling
 #'   `pkgconfig::set_config("dplyr::na_matches" = "never")`.
+#' @param method
+#'   How rows are matched. `"hash"` uses a hash table. `"merge"` merges
+#'   both tables in the order of the keys, sorting first the tables that are
+#'   not already sorted; the rows of the result then follow the order of the
+#'   keys. The default, `"auto"`, uses the merge when both tables are already
+#'   sorted on the keys, e.g. after [arrange()], which gives the same result
+#'   as the hash table without its memory. Character keys count as sorted
+#'   in the C locale.
 #' @examples
 #' if (require("Lahman")) {
 #' batting_df <- tbl_df(Batting)
@@ -151,68 +173,136 @@ check_na_matches <- function(na_matches) {
 #' @rdname join.tbl_df
 inner_join.tbl_df <- function(x, y, by = NULL, copy = FALSE,
                               suffix = c(".x", ".y"), ...,
-                              na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                              na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                              method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   suffix <- check_suffix(suffix)
 
   y <- auto_copy(x, y, copy = copy)
 
-  inner_join_impl(x, y, by$x, by$y, suffix$x, suffix$y, check_na_matches(na_matches))
+  inner_join_impl(
+    x, y, by$x, by$y, suffix$x, suffix$y,
+    check_na_matches(na_matches), match.arg(method)
+  )
 }
 
 #' @export
 #' @rdname join.tbl_df
 left_join.tbl_df <- function(x, y, by = NULL, copy = FALSE,
                              suffix = c(".x", ".y"), ...,
-                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                             na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                             method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   suffix <- check_suffix(suffix)
 
   y <- auto_copy(x, y, copy = copy)
 
-  left_join_impl(x, y, by$x, by$y, suffix$x, suffix$y, check_na_matches(na_matches))
+  left_join_impl(
+    x, y, by$x, by$y, suffix$x, suffix$y,
+    check_na_matches(na_matches), match.arg(method)
+  )
 }
 
 #' @export
 #' @rdname join.tbl_df
 right_join.tbl_df <- function(x, y, by = NULL, copy = FALSE,
                               suffix = c(".x", ".y"), ...,
-                              na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                              na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                              method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   suffix <- check_suffix(suffix)
 
   y <- auto_copy(x, y, copy = copy)
-  right_join_impl(x, y, by$x, by$y, suffix$x, suffix$y, check_na_matches(na_matches))
+  right_join_impl(
+    x, y, by$x, by$y, suffix$x, suffix$y,
+    check_na_matches(na_matches), match.arg(method)
+  )
 }
 
 #' @export
 #' @rdname join.tbl_df
 full_join.tbl_df <- function(x, y, by = NULL, copy = FALSE,
                              suffix = c(".x", ".y"), ...,
-                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                             na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                             method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   suffix <- check_suffix(suffix)
 
   y <- auto_copy(x, y, copy = copy)
-  full_join_impl(x, y, by$x, by$y, suffix$x, suffix$y, check_na_matches(na_matches))
+  full_join_impl(
+    x, y, by$x, by$y, suffix$x, suffix$y,
+    check_na_matches(na_matches), match.arg(method)
+  )
 }
 
 #' @export
 #' @rdname join.tbl_df
 semi_join.tbl_df <- function(x, y, by = NULL, copy = FALSE, ...,
-                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                             na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                             method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   y <- auto_copy(x, y, copy = copy)
-  semi_join_impl(x, y, by$x, by$y, check_na_matches(na_matches))
+  semi_join_impl(x, y, by$x, by$y, check_na_matches(na_matches), match.arg(method))
 }
 
 #' @export
 #' @rdname join.tbl_df
 anti_join.tbl_df <- function(x, y, by = NULL, copy = FALSE, ...,
-                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+                             na_matches = pkgconfig::get_config("dplyr::na_matches"),
+                             method = c("auto", "hash", "merge")) {
   by <- common_by(by, x, y)
   y <- auto_copy(x, y, copy = copy)
-  anti_join_impl(x, y, by$x, by$y, check_na_matches(na_matches))
+  anti_join_impl(x, y, by$x, by$y, check_na_matches(na_matches), match.arg(method))
+}
+
+#' @export
+#' @rdname join.tbl_df
+asof_join.tbl_df <- function(x, y, on, by = character(),
+                             direction = c("backward", "forward", "nearest"),
+                             tolerance = Inf, suffix = c(".x", ".y"), ...,
+                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+  on <- check_asof_on(on, x, y)
+  by <- common_by(as.character(by), x, y)
+  suffix <- check_suffix(suffix)
+
+  asof_join_impl(
+    x, y, by$x, by$y, on$x, on$y,
+    match.arg(direction), check_tolerance(tolerance),
+    suffix$x, suffix$y, check_na_matches(na_matches)
+  )
+}
+
+#' @export
+#' @rdname join.tbl_df
+inequality_join.tbl_df <- function(x, y, conditions, by = character(),
+                                   type = c("inner", "left"),
+                                   suffix = c(".x", ".y"), ...,
+                                   na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+  on <- parse_join_conditions(conditions, x, y)
+  by <- common_by(as.character(by), x, y)
+  suffix <- check_suffix(suffix)
+
+  inequality_join_impl(
+    x, y, by$x, by$y, on$x, on$y, on$op,
+    match.arg(type) == "left",
+    suffix$x, suffix$y, check_na_matches(na_matches)
+  )
+}
+
+#' @export
+#' @rdname star_join
+star_join.tbl_df <- function(x, dims, by = NULL, suffix = NULL, copy = FALSE, ...,
+                             na_matches = pkgconfig::get_config("dplyr::na_matches")) {
+  dims <- check_star_dims(dims)
+  by <- check_star_by(by, x, dims)
+  suffix <- check_star_suffix(suffix, dims)
+
+  dims <- map(dims, auto_copy, x = x, copy = copy)
+
+  star_join_impl(
+    x, unname(dims), map(by, `[[`, "x"), map(by, `[[`, "y"),
+    suffix, check_na_matches(na_matches)
+  )
 }
 
 
@@ -1,7 +1,11 @@
 .onLoad <- function(libname, pkgname) {
   op <- options()
   op.dplyr <- list(
-    dplyr.show_progress = TRUE
+    dplyr.show_progress = TRUE,
+    dplyr.threads = 1L,
+    dplyr.ordered_groups = TRUE,
+    dplyr.group_cache_size = 0,
+    dplyr.collation = "locale"
   )
   toset <- !(names(op.dplyr) %in% names(op))
   if (any(toset)) options(op.dplyr[toset])
@@ -5,6 +5,10 @@
 
 namespace dplyr {
 
+// Should strings be ordered by their bytes? That is the case when the
+// `dplyr.collation` option is "C", or when R collates in the C locale.
+bool collate_bytes();
+
 class CharacterVectorOrderer {
 public:
 
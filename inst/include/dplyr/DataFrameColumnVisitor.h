@@ -41,6 +41,10 @@ public:
     return false;
   }
 
+  void provide_orders() const {
+    visitors.provide_orders();
+  }
+
 private:
   DataFrame data;
   DataFrameVisitors visitors;
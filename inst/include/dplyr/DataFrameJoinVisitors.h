@@ -39,6 +39,23 @@ public:
     return nvisitors;
   }
 
+  // compares rows i and j on the keys, in turn: -1, 0 or 1
+  inline int compare(int i, int j) const {
+    for (int k = 0; k < nvisitors; k++) {
+      int res = get(k)->compare(i, j);
+      if (res != 0) return res;
+    }
+    return 0;
+  }
+
+  // can all the visitors run on the worker threads
+  inline bool thread_safe() const {
+    for (int k = 0; k < nvisitors; k++) {
+      if (!get(k)->thread_safe()) return false;
+    }
+    return true;
+  }
+
   template <typename Container>
   inline DataFrame subset(const Container& index, const CharacterVector& classes) {
     int nrows = index.size();
@@ -45,6 +45,19 @@ public:
     return data.nrows();
   }
 
+  inline void provide_orders() const {
+    for (int k = 0; k < nvisitors; k++) {
+      visitors[k]->provide_orders();
+    }
+  }
+
+  inline bool thread_safe() const {
+    for (int k = 0; k < nvisitors; k++) {
+      if (!visitors[k]->thread_safe()) return false;
+    }
+    return true;
+  }
+
 private:
 
   void structure(List& x, int nrows, CharacterVector classes) const;
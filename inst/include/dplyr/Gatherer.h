@@ -27,7 +27,7 @@ class GathererImpl : public Gatherer {
 public:
   typedef GroupedCallProxy<Data, Subsets> Proxy;
 
-  GathererImpl(RObject& first, SlicingIndex& indices, Proxy& proxy_, const Data& gdf_, int first_non_na_, const SymbolString& name_) :
+  GathererImpl(RObject& first, const SlicingIndex& indices, Proxy& proxy_, const Data& gdf_, int first_non_na_, const SymbolString& name_) :
     gdf(gdf_), proxy(proxy_), first_non_na(first_non_na_), name(name_)
   {
     coll = collecter(first, gdf.nrows());
@@ -124,7 +124,7 @@ class ListGatherer : public Gatherer {
 public:
   typedef GroupedCallProxy<Data, Subsets> Proxy;
 
-  ListGatherer(List first, SlicingIndex& indices, Proxy& proxy_, const Data& gdf_, int first_non_na_, const SymbolString& name_) :
+  ListGatherer(List first, const SlicingIndex& indices, Proxy& proxy_, const Data& gdf_, int first_non_na_, const SymbolString& name_) :
     gdf(gdf_), proxy(proxy_), data(gdf.nrows()), first_non_na(first_non_na_), name(name_)
   {
     if (first_non_na < gdf.ngroups()) {
@@ -245,15 +245,14 @@ inline Gatherer* constant_gatherer(SEXP x, int n, const SymbolString& name) {
 template <typename Data, typename Subsets>
 inline Gatherer* gatherer(GroupedCallProxy<Data, Subsets>& proxy, const Data& gdf, const SymbolString& name) {
   typename Data::group_iterator git = gdf.group_begin();
-  typename Data::slicing_index indices = *git;
-  RObject first(proxy.get(indices));
+  RObject first(proxy.get(*git));
 
   if (Rf_inherits(first, "POSIXlt")) {
     bad_col(name, "is of unsupported class POSIXlt");
   }
 
   check_supported_type(first, name);
-  check_length(Rf_length(first), indices.size(), "the group size", name);
+  check_length(Rf_length(first), (*git).size(), "the group size", name);
 
   const int ng = gdf.ngroups();
   int i = 0;
@@ -261,15 +260,14 @@ inline Gatherer* gatherer(GroupedCallProxy<Data, Subsets>& proxy, const Data& gd
     i++;
     if (i == ng) break;
     ++git;
-    indices = *git;
-    first = proxy.get(indices);
+    first = proxy.get(*git);
   }
 
 
   if (TYPEOF(first) == VECSXP) {
-    return new ListGatherer<Data, Subsets> (List(first), indices, proxy, gdf, i, name);
+    return new ListGatherer<Data, Subsets> (List(first), *git, proxy, gdf, i, name);
   } else {
-    return new GathererImpl<Data, Subsets> (first, indices, proxy, gdf, i, name);
+    return new GathererImpl<Data, Subsets> (first, *git, proxy, gdf, i, name);
   }
 }
 
@@ -36,6 +36,16 @@ inline void check_valid_colnames(const DataFrame& df) {
   }
 }
 
+// true if the rows of each group are consecutive, i.e. the data is sorted by the groups
+inline bool is_contiguous_index(const IntegerVector& rows) {
+  const int n = rows.size();
+  const int* p = Rcpp::internal::r_vector_start<INTSXP>(rows);
+  for (int i = 0; i < n; i++) {
+    if (p[i] != i) return false;
+  }
+  return true;
+}
+
 class GroupedDataFrame;
 
 class GroupedDataFrameIndexIterator {
@@ -44,17 +54,25 @@ public:
 
   GroupedDataFrameIndexIterator& operator++();
 
-  GroupedSlicingIndex operator*() const;
+  // the returned index is updated when the iterator moves
+  const SlicingIndex& operator*() const;
 
   int i;
   const GroupedDataFrame& gdf;
-  List indices;
+  const int* rows;
+  const int* offsets;
+
+private:
+  void update();
+
+  FlatGroupedSlicingIndex flat_index;
+  RangeSlicingIndex range_index;
 };
 
 class GroupedDataFrame {
 public:
   typedef GroupedDataFrameIndexIterator group_iterator;
-  typedef GroupedSlicingIndex slicing_index;
+  typedef SlicingIndex slicing_index;
   typedef GroupedSubset subset;
 
   GroupedDataFrame(SEXP x):
@@ -62,10 +80,18 @@ public:
     group_sizes(),
     biggest_group_size(0),
     symbols(get_vars(data_)),
-    labels()
+    labels(),
+    group_rows(),
+    group_offsets(),
+    contiguous(false)
   {
     // handle lazyness
-    bool is_lazy = Rf_isNull(data_.attr("group_sizes")) || Rf_isNull(data_.attr("labels"));
+    bool is_lazy =
+      Rf_isNull(data_.attr("indices")) ||
+      Rf_isNull(data_.attr("group_sizes")) ||
+      Rf_isNull(data_.attr("labels")) ||
+      Rf_isNull(data_.attr("group_rows")) ||
+      Rf_isNull(data_.attr("group_offsets"));
 
     if (is_lazy) {
       data_ = build_index_cpp(data_);
@@ -73,6 +99,8 @@ public:
     group_sizes = data_.attr("group_sizes");
     biggest_group_size  = data_.attr("biggest_group_size");
     labels = data_.attr("labels");
+    group_rows = data_.attr("group_rows");
+    group_offsets = data_.attr("group_offsets");
 
     if (!is_lazy) {
       // check consistency of the groups
@@ -81,7 +109,14 @@ public:
         bad_arg(".data", "is a corrupt grouped_df, contains {rows} rows, and {group_rows} rows in groups",
                 _["rows"] = data_.nrows(), _["group_rows"] = rows_in_groups);
       }
+      if (group_rows.size() != rows_in_groups || group_offsets.size() != group_sizes.size() + 1) {
+        bad_arg(".data", "is a corrupt grouped_df, its group index does not match its {ngroups} groups",
+                _["ngroups"] = group_sizes.size());
+      }
     }
+
+    // groups of data sorted by the grouping variables are iterated as ranges of rows
+    contiguous = is_contiguous_index(group_rows);
   }
 
   group_iterator group_begin() const {
@@ -127,6 +162,21 @@ public:
     return grouped_subset(x, max_group_size());
   }
 
+  // row ids of all groups, one group after the other
+  inline const IntegerVector& rows() const {
+    return group_rows;
+  }
+
+  // the rows of group i are rows()[offsets()[i]] to rows()[offsets()[i + 1] - 1]
+  inline const IntegerVector& offsets() const {
+    return group_offsets;
+  }
+
+  // true if each group is a range of consecutive rows
+  inline bool is_contiguous() const {
+    return contiguous;
+  }
+
 private:
 
   DataFrame data_;
@@ -134,19 +184,43 @@ private:
   int biggest_group_size;
   SymbolMap symbols;
   DataFrame labels;
+  IntegerVector group_rows;
+  IntegerVector group_offsets;
+  bool contiguous;
 
 };
 
 inline GroupedDataFrameIndexIterator::GroupedDataFrameIndexIterator(const GroupedDataFrame& gdf_) :
-  i(0), gdf(gdf_), indices(gdf.data().attr("indices")) {}
+  i(0), gdf(gdf_),
+  rows(Rcpp::internal::r_vector_start<INTSXP>(gdf.rows())),
+  offsets(Rcpp::internal::r_vector_start<INTSXP>(gdf.offsets())),
+  flat_index(rows, 0, 0),
+  range_index(0, 0, 0)
+{
+  update();
+}
 
 inline GroupedDataFrameIndexIterator& GroupedDataFrameIndexIterator::operator++() {
   i++;
+  update();
   return *this;
 }
 
-inline GroupedSlicingIndex GroupedDataFrameIndexIterator::operator*() const {
-  return GroupedSlicingIndex(IntegerVector(indices[i]), i);
+inline const SlicingIndex& GroupedDataFrameIndexIterator::operator*() const {
+  if (gdf.is_contiguous()) return range_index;
+  return flat_index;
+}
+
+inline void GroupedDataFrameIndexIterator::update() {
+  if (i >= gdf.ngroups()) return;
+
+  int start = offsets[i];
+  int n = offsets[i + 1] - start;
+  if (gdf.is_contiguous()) {
+    range_index = RangeSlicingIndex(start, n, i);
+  } else {
+    flat_index = FlatGroupedSlicingIndex(rows + start, n, i);
+  }
 }
 
 }
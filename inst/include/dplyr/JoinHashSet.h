@@ -0,0 +1,121 @@
+#ifndef dplyr_JoinHashSet_H
+#define dplyr_JoinHashSet_H
+
+#include <dplyr/JoinHashTable.h>
+
+namespace dplyr {
+
+// Set of the distinct keys of a table, used by semi_join() and anti_join()
+// to stream the larger table against the keys of the smaller one.
+//
+// Keys live in an open addressing array as in JoinHashTable, without their
+// rows. A Bloom filter of a byte per key sits in front of the array: it fits
+// in cache when the array does not, and rejects most of the rows without a
+// match with DPLYR_JOIN_BLOOM_PROBES bit tests instead of a probe.
+//
+// Rows are identified as in the visitor set. contains() only reads the set,
+// so the rows can be tested on several threads if the visitors allow it.
+template <typename VisitorSet>
+class JoinHashSet {
+public:
+  JoinHashSet(VisitorSet& visitors_) :
+    visitors(visitors_), mask(0), bloom_mask(0), nkeys(0)
+  {}
+
+  // builds the set of the keys of the n rows of the left table, or of the right table if right is true
+  void build(int n, bool right) {
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)n) capacity *= 2;
+    mask = capacity - 1;
+    slots.assign(capacity, -1);
+
+    size_t bloom_bits = 64;
+    while (bloom_bits < 8 * (size_t)n) bloom_bits *= 2;
+    bloom_mask = bloom_bits - 1;
+    bloom.assign(bloom_bits / 8, 0);
+
+    key_rows.clear();
+    key_hashes.clear();
+    nkeys = 0;
+
+    for (int i = 0; i < n; i++) {
+      int idx = right ? -i - 1 : i;
+      size_t h = visitors.hash(idx);
+      if (!lookup(idx, h)) insert(idx, h);
+    }
+  }
+
+  // true if row idx of either table has a key of the set
+  inline bool contains(int idx) const {
+    return contains(idx, visitors.hash(idx));
+  }
+
+  // same, with the hash of row idx already known
+  inline bool contains(int idx, size_t h) const {
+    if (nkeys == 0 || !bloom_test(JoinHashTable<VisitorSet>::mix(h))) return false;
+    return lookup(idx, h);
+  }
+
+  inline int size() const {
+    return nkeys;
+  }
+
+private:
+
+  // the bits of a key in the Bloom filter, by double hashing of the mixed hash
+  inline size_t bloom_bit(size_t m, int j) const {
+    return (m + j * ((m >> 17) | 1)) & bloom_mask;
+  }
+
+  inline bool bloom_test(size_t m) const {
+    for (int j = 0; j < DPLYR_JOIN_BLOOM_PROBES; j++) {
+      size_t bit = bloom_bit(m, j);
+      if (!(bloom[bit >> 3] & (1 << (bit & 7)))) return false;
+    }
+    return true;
+  }
+
+  inline bool lookup(int idx, size_t h) const {
+    size_t i = JoinHashTable<VisitorSet>::mix(h) & mask;
+    while (true) {
+      int k = slots[i];
+      if (k < 0) return false;
+      if (key_hashes[k] == h && visitors.equal(key_rows[k], idx)) return true;
+      i = (i + 1) & mask;
+    }
+  }
+
+  inline void insert(int idx, size_t h) {
+    size_t m = JoinHashTable<VisitorSet>::mix(h);
+    size_t i = m & mask;
+    while (slots[i] >= 0) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = nkeys++;
+    key_rows.push_back(idx);
+    key_hashes.push_back(h);
+
+    for (int j = 0; j < DPLYR_JOIN_BLOOM_PROBES; j++) {
+      size_t bit = bloom_bit(m, j);
+      bloom[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+    }
+  }
+
+  VisitorSet& visitors;
+
+  // key number in each slot of the open addressing array, -1 if empty
+  std::vector<int> slots;
+  size_t mask;
+
+  std::vector<unsigned char> bloom;
+  size_t bloom_mask;
+
+  // for each key: a row with that key, the hash of the key
+  int nkeys;
+  std::vector<int> key_rows;
+  std::vector<size_t> key_hashes;
+};
+
+}
+
+#endif
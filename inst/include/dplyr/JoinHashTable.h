@@ -0,0 +1,227 @@
+#ifndef dplyr_JoinHashTable_H
+#define dplyr_JoinHashTable_H
+
+namespace dplyr {
+
+// Hash table used by the joins.
+//
+// Distinct keys live in an open addressing array with linear probing, and
+// the rows of each key are stored contiguously in a single buffer that is
+// filled with a counting pass, so building the table allocates a fixed
+// number of vectors whatever the number of distinct keys.
+//
+// Rows are identified as in the visitor set: i >= 0 is the i-th row of the
+// left table and -i-1 the i-th row of the right table. The rows stored in
+// the table are plain row numbers of the table it was built on, in
+// ascending order within each key.
+//
+// The content of the table is kept in a JoinHashTableData, so that a table
+// built once can be kept (see KeyIndex) and probed later through other
+// visitors, as long as they hash and compare the rows the same way and see
+// the table it was built on on the same side.
+struct JoinHashTableData {
+  JoinHashTableData() : mask(0), nkeys(0) {}
+
+  // key number in each slot of the open addressing array, -1 if empty
+  std::vector<int> slots;
+  size_t mask;
+
+  // for each key: a row with that key, the hash of the key
+  int nkeys;
+  std::vector<int> key_rows;
+  std::vector<size_t> key_hashes;
+
+  // rows of key k are rows[offsets[k]] to rows[offsets[k + 1] - 1]
+  std::vector<int> offsets;
+  std::vector<int> rows;
+};
+
+// the low bits of the slot number must depend on all the bits of the hash
+inline size_t mix_hash(size_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+  return h;
+}
+
+template <typename VisitorSet>
+class JoinHashTable {
+public:
+  JoinHashTable(VisitorSet& visitors_) :
+    visitors(visitors_), data(own)
+  {}
+
+  // probes a table that was built elsewhere, the data must outlive this object
+  JoinHashTable(VisitorSet& visitors_, const JoinHashTableData& data_) :
+    visitors(visitors_), data(const_cast<JoinHashTableData&>(data_))
+  {}
+
+  // builds the table in data, which must outlive this object
+  JoinHashTable(VisitorSet& visitors_, JoinHashTableData& data_) :
+    visitors(visitors_), data(data_)
+  {}
+
+  // builds the table over the n rows of the left table, or of the right table if right is true
+  void build(int n, bool right) {
+    build(n, right, NULL, NULL);
+  }
+
+  // builds the table over n rows of the left or right table given by their row numbers,
+  // in ascending order, and their hashes. NULL rows means all the rows, NULL hashes
+  // means the hashes are computed here.
+  void build(int n, bool right, const int* row_numbers, const size_t* hashes) {
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)n) capacity *= 2;
+    data.mask = capacity - 1;
+    data.slots.assign(capacity, -1);
+
+    data.key_rows.clear();
+    data.key_hashes.clear();
+    data.nkeys = 0;
+
+    std::vector<int> row_keys(n);
+    std::vector<int> counts;
+    for (int i = 0; i < n; i++) {
+      int row = row_numbers ? row_numbers[i] : i;
+      int idx = right ? -row - 1 : row;
+      size_t h = hashes ? hashes[i] : visitors.hash(idx);
+
+      int k = lookup(idx, h);
+      if (k < 0) {
+        k = insert(idx, h);
+        counts.push_back(0);
+      }
+      row_keys[i] = k;
+      counts[k]++;
+    }
+
+    data.offsets.resize(data.nkeys + 1);
+    data.offsets[0] = 0;
+    for (int k = 0; k < data.nkeys; k++) {
+      data.offsets[k + 1] = data.offsets[k] + counts[k];
+    }
+
+    // counts become the insertion positions
+    std::copy(data.offsets.begin(), data.offsets.end() - 1, counts.begin());
+    data.rows.resize(n);
+    for (int i = 0; i < n; i++) {
+      data.rows[counts[row_keys[i]]++] = row_numbers ? row_numbers[i] : i;
+    }
+  }
+
+  // the key matching row idx of either table, -1 if there is none
+  inline int find(int idx) const {
+    if (data.nkeys == 0) return -1;
+    return lookup(idx, visitors.hash(idx));
+  }
+
+  // same, with the hash of row idx already known
+  inline int find(int idx, size_t h) const {
+    if (data.nkeys == 0) return -1;
+    return lookup(idx, h);
+  }
+
+  static inline size_t mix(size_t h) {
+    return mix_hash(h);
+  }
+
+  inline int size() const {
+    return data.nkeys;
+  }
+
+  // number of rows with key k
+  inline int count(int k) const {
+    return data.offsets[k + 1] - data.offsets[k];
+  }
+
+  // rows with key k, in ascending order
+  inline const int* begin(int k) const {
+    return &data.rows[0] + data.offsets[k];
+  }
+  inline const int* end(int k) const {
+    return &data.rows[0] + data.offsets[k + 1];
+  }
+
+  // the content of the table, e.g. to keep it after the visitors are gone
+  inline const JoinHashTableData& get_data() const {
+    return data;
+  }
+
+private:
+
+  inline int lookup(int idx, size_t h) const {
+    size_t i = mix(h) & data.mask;
+    while (true) {
+      int k = data.slots[i];
+      if (k < 0) return -1;
+      if (data.key_hashes[k] == h && visitors.equal(data.key_rows[k], idx)) return k;
+      i = (i + 1) & data.mask;
+    }
+  }
+
+  inline int insert(int idx, size_t h) {
+    size_t i = mix(h) & data.mask;
+    while (data.slots[i] >= 0) {
+      i = (i + 1) & data.mask;
+    }
+    data.slots[i] = data.nkeys;
+    data.key_rows.push_back(idx);
+    data.key_hashes.push_back(h);
+    return data.nkeys++;
+  }
+
+  // data refers to own, or to a table built elsewhere, so no copies
+  JoinHashTable(const JoinHashTable&);
+  JoinHashTable& operator=(const JoinHashTable&);
+
+  VisitorSet& visitors;
+  JoinHashTableData own;
+  JoinHashTableData& data;
+};
+
+// Number of hash partitions of n rows on nthreads threads: a few for each
+// thread, so that the threads stay busy, and enough for the table of each
+// partition to fit in cache
+inline int hash_partitions(int n, int nthreads) {
+  int npartitions = 1;
+  while (npartitions < 4096 && (npartitions < 4 * nthreads || npartitions * (double)DPLYR_JOIN_PARTITION_SIZE < n)) {
+    npartitions *= 2;
+  }
+  return npartitions;
+}
+
+// The partition of a row is given by high bits of its mixed hash,
+// the low bits choose its slot in the hash table of the partition.
+inline int partition_of(size_t h, int npartitions) {
+  return (mix_hash(h) >> 20) & (npartitions - 1);
+}
+
+// Groups rows by partition, in ascending order within each partition: the rows of
+// partition p are rows[offsets[p]] to rows[offsets[p + 1] - 1], with their hashes
+// at the same positions in part_hashes.
+inline void partition_rows(const std::vector<size_t>& hashes, int npartitions,
+                           std::vector<int>& offsets, std::vector<int>& rows, std::vector<size_t>& part_hashes) {
+  int n = hashes.size();
+  offsets.assign(npartitions + 1, 0);
+  for (int i = 0; i < n; i++) {
+    offsets[partition_of(hashes[i], npartitions) + 1]++;
+  }
+  for (int p = 0; p < npartitions; p++) {
+    offsets[p + 1] += offsets[p];
+  }
+
+  std::vector<int> pos(offsets.begin(), offsets.end() - 1);
+  rows.resize(n);
+  part_hashes.resize(n);
+  for (int i = 0; i < n; i++) {
+    int k = pos[partition_of(hashes[i], npartitions)]++;
+    rows[k] = i;
+    part_hashes[k] = hashes[i];
+  }
+}
+
+}
+
+#endif
@@ -15,6 +15,13 @@ public:
   virtual size_t hash(int i) = 0;
   virtual bool equal(int i, int j) = 0;
 
+  // -1, 0 or 1 as row i sorts before, with or after row j, NA last
+  virtual int compare(int i, int j) = 0;
+
+  // can hash(), equal() and compare() run on the worker threads, i.e. without
+  // calling the R API
+  virtual bool thread_safe() const = 0;
+
   virtual SEXP subset(const std::vector<int>& indices) = 0;
   virtual SEXP subset(const VisitorSetIndexSet<DataFrameJoinVisitors>& set) = 0;
 
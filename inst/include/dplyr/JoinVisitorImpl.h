@@ -161,6 +161,20 @@ public:
     }
   }
 
+  // orders values as arrange() does, strings in the C locale
+  inline int compare(int i, int j) {
+    typedef comparisons<Storage::RTYPE> compare_values;
+    typename Storage::STORAGE lhs = dual.get_value(i), rhs = dual.get_value(j);
+    if (compare_values::is_less(lhs, rhs)) return -1;
+    if (compare_values::is_less(rhs, lhs)) return 1;
+    return 0;
+  }
+
+  // strings are read with STRING_ELT()
+  inline bool thread_safe() const {
+    return LHS_RTYPE != STRSXP && RHS_RTYPE != STRSXP;
+  }
+
   SEXP subset(const std::vector<int>& indices) {
     return dual.subset(indices.begin(), indices.size());
   }
@@ -0,0 +1,66 @@
+#ifndef dplyr_KeyIndex_H
+#define dplyr_KeyIndex_H
+
+#include <tools/SymbolVector.h>
+
+#include <dplyr/DataFrameJoinVisitors.h>
+#include <dplyr/JoinHashTable.h>
+
+namespace dplyr {
+
+// Hash index over some columns of a data frame, created by add_key_index()
+// and attached to the data frame as an external pointer in its "key_index"
+// attribute. It is reused by the joins that have the data frame as `y` and
+// by equality filters on the key.
+//
+// The index keeps the columns it was built on alive and marks them as shared,
+// as the group cache does, and is only used while the data frame still has
+// these very columns: a modified or replaced column gets a new address, and
+// the index is then ignored rather than giving wrong results.
+//
+// The table is built with the keys as the right table of join visitors that
+// match NA, so that the join visitors of another data frame can probe it with
+// the keys as their right table, as long as they hash and compare the keys in
+// the same way, see compatible().
+class KeyIndex {
+public:
+  KeyIndex(const DataFrame& data, const SymbolVector& vars);
+
+  // the index attached to data, if it is still valid, NULL otherwise
+  static KeyIndex* get(const DataFrame& data);
+
+  // true if the columns of data have not changed since the index was built
+  bool valid_for(const DataFrame& data) const;
+
+  // the position of each key in names, or an empty vector unless names are the keys in any order
+  IntegerVector positions_in(const SymbolVector& names) const;
+
+  // true if the columns vars of data can probe the table, i.e. they get join visitors
+  // of the same kind as the keys: same type, same factor levels, same date classes
+  bool compatible(const DataFrame& data, const SymbolVector& vars) const;
+
+  const DataFrame& get_keys() const {
+    return keys;
+  }
+  const SymbolVector& get_vars() const {
+    return vars;
+  }
+  const JoinHashTableData& get_table() const {
+    return table;
+  }
+
+private:
+  // the columns of the data frame, to check it still has them
+  List columns;
+
+  // the same columns as seen by the join visitors, with strings in UTF-8
+  DataFrame keys;
+  SymbolVector vars;
+
+  int nrows;
+  JoinHashTableData table;
+};
+
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define dplyr_Order_H
 
 #include <tools/pointer_vector.h>
+#include <tools/parallel_sort.h>
 
 #include <dplyr/OrderVisitorImpl.h>
+#include <dplyr/SortKeys.h>
 
 namespace dplyr {
 
@@ -69,9 +71,36 @@ private:
 
 inline Rcpp::IntegerVector OrderVisitors::apply() const {
   if (nrows == 0) return IntegerVector(0);
-  IntegerVector x = seq(0, nrows - 1);
-  std::sort(x.begin(), x.end(), OrderVisitors_Compare(*this));
-  return x;
+
+  // rows sort on their normalized keys, in a single radix sort
+  if (nrows >= DPLYR_MIN_RADIX_SORT_SIZE && SortKeys::sortable(visitors)) {
+    std::vector<int> order(nrows);
+    for (int i = 0; i < nrows; i++) {
+      order[i] = i;
+    }
+    SortKeys(visitors, nrows).sort(order);
+    return wrap(order);
+  }
+
+  int nthreads = get_nthreads(nrows);
+  if (nthreads == 1) {
+    IntegerVector x = seq(0, nrows - 1);
+    std::sort(x.begin(), x.end(), OrderVisitors_Compare(*this));
+    return x;
+  }
+
+  // the visitors compare rows on the worker threads, where they must not
+  // compute anything through the R API
+  for (int k = 0; k < n; k++) {
+    visitors[k]->provide_orders();
+  }
+
+  std::vector<int> order(nrows);
+  for (int i = 0; i < nrows; i++) {
+    order[i] = i;
+  }
+  parallel_stable_sort(order, OrderVisitors_Compare(*this), nthreads);
+  return wrap(order);
 }
 
 
@@ -1,6 +1,8 @@
 #ifndef dplyr_OrderVisitor_H
 #define dplyr_OrderVisitor_H
 
+#include <dplyr/RadixSort.h>
+
 namespace dplyr {
 
 class OrderVisitor {
@@ -15,6 +17,17 @@ public:
 
   virtual SEXP get() = 0;
 
+  /** number of bytes of the radix sort keys of the elements, 0 if they have none */
+  virtual int radix_bytes() const {
+    return 0;
+  }
+
+  /** radix sort keys of the n elements, ordered as before() and equal() order the elements */
+  virtual void radix_keys(int n, std::vector<radix_key>& keys) const {}
+
+  /** computes up front what equal() and before() compute on first use, so that they can be called on several threads */
+  virtual void provide_orders() const {}
+
 };
 
 } // namespace dplyr
@@ -38,6 +38,17 @@ public:
     return vec;
   }
 
+  int radix_bytes() const {
+    return radix_traits<RTYPE, ascending>::nbytes;
+  }
+
+  void radix_keys(int n, std::vector<radix_key>& keys) const {
+    keys.resize(n);
+    for (int i = 0; i < n; i++) {
+      keys[i] = radix_traits<RTYPE, ascending>::key(vec[i]);
+    }
+  }
+
 private:
   VECTOR vec;
 };
@@ -68,6 +79,17 @@ public:
     return vec;
   }
 
+  int radix_bytes() const {
+    return radix_traits<RTYPE, false>::nbytes;
+  }
+
+  void radix_keys(int n, std::vector<radix_key>& keys) const {
+    keys.resize(n);
+    for (int i = 0; i < n; i++) {
+      keys[i] = radix_traits<RTYPE, false>::key(vec[i]);
+    }
+  }
+
 private:
   VECTOR vec;
 };
@@ -92,6 +114,15 @@ public:
     return vec;
   }
 
+  // the ranks of the strings sort as integers
+  int radix_bytes() const {
+    return orders.radix_bytes();
+  }
+
+  void radix_keys(int n, std::vector<radix_key>& keys) const {
+    orders.radix_keys(n, keys);
+  }
+
 private:
   CharacterVector vec;
   OrderVectorVisitorImpl<INTSXP, ascending, IntegerVector> orders;
@@ -117,6 +148,10 @@ public:
     return data;
   }
 
+  void provide_orders() const {
+    visitors.provide_orders();
+  }
+
 private:
   DataFrame data;
   DataFrameVisitors visitors;
@@ -139,6 +174,10 @@ public:
     return data;
   }
 
+  void provide_orders() const {
+    visitors.provide_orders();
+  }
+
 private:
   DataFrame data;
   DataFrameVisitors visitors;
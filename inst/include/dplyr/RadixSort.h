@@ -0,0 +1,63 @@
+#ifndef dplyr_RadixSort_H
+#define dplyr_RadixSort_H
+
+#include <boost/cstdint.hpp>
+
+#include <cstring>
+
+namespace dplyr {
+
+typedef boost::uint64_t radix_key;
+
+// Radix sort keys of the values of a vector: unsigned integers whose order is
+// the order comparisons<RTYPE> gives to the values, missing values last, and
+// that are equal for values that compare equal. Only the nbytes low bytes of
+// the keys are used; types without such keys have nbytes = 0.
+template <int RTYPE, bool ascending>
+struct radix_traits {
+  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
+  enum { nbytes = 0 };
+
+  static inline radix_key key(STORAGE) {
+    return 0;
+  }
+};
+
+template <bool ascending>
+struct radix_traits<INTSXP, ascending> {
+  enum { nbytes = 4 };
+
+  static inline radix_key key(int x) {
+    // NA is INT_MIN, which leaves 2^32 - 1 other values below the key of NA
+    if (x == NA_INTEGER) return 0xFFFFFFFFu;
+    boost::uint32_t u = static_cast<boost::uint32_t>(x);
+    return ascending ? u + 0x7FFFFFFFu : 0x7FFFFFFFu - u;
+  }
+};
+
+template <bool ascending>
+struct radix_traits<LGLSXP, ascending> : radix_traits<INTSXP, ascending> {};
+
+template <bool ascending>
+struct radix_traits<REALSXP, ascending> {
+  enum { nbytes = 8 };
+
+  static inline radix_key key(double x) {
+    // NA then NaN come after all the numbers, in both directions
+    if (ISNAN(x)) return R_IsNA(x) ? ~(radix_key)1 : ~(radix_key)0;
+
+    // -0 and 0 are equal
+    if (x == 0) x = 0;
+
+    // the bits of positive numbers get the sign bit, those of negative numbers are flipped,
+    // so that the keys of numbers are at most the key of Inf, 0xFFF0000000000000
+    radix_key bits;
+    std::memcpy(&bits, &x, sizeof(double));
+    bits = (bits >> 63) ? ~bits : bits | ((radix_key)1 << 63);
+    return ascending ? bits : ~bits;
+  }
+};
+
+}
+
+#endif
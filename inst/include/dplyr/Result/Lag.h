@@ -68,6 +68,17 @@ public:
 private:
 
   void process_slice(Vector<RTYPE>& out, const SlicingIndex& index, const SlicingIndex& out_index) {
+    int chunk_size = index.size();
+    if (chunk_size > 0 && index.is_contiguous() && out_index.is_contiguous()) {
+      // sequential reads and writes, RangeSlicingIndex is final so no virtual dispatch per row
+      process_slice_impl(out, RangeSlicingIndex(index[0], chunk_size), RangeSlicingIndex(out_index[0], chunk_size));
+    } else {
+      process_slice_impl(out, index, out_index);
+    }
+  }
+
+  template <typename Index, typename OutIndex>
+  void process_slice_impl(Vector<RTYPE>& out, const Index& index, const OutIndex& out_index) {
     int chunk_size = index.size();
     int n_def = std::min(chunk_size, n);
 
@@ -27,6 +27,23 @@ public:
   double process_chunk(const SlicingIndex& indices) {
     if (is_summary) return data_ptr[ indices.group() ];
 
+    if (indices.is_contiguous() && indices.size() > 0) {
+      // sequential read, no virtual dispatch per row as RangeSlicingIndex is final
+      return process_chunk_impl(RangeSlicingIndex(indices[0], indices.size()));
+    }
+    return process_chunk_impl(indices);
+  }
+
+  inline static bool is_better(const double current, const double res) {
+    if (MINIMUM)
+      return internal::is_smaller<REALSXP>(current, res);
+    else
+      return internal::is_smaller<REALSXP>(res, current);
+  }
+
+private:
+  template <typename Index>
+  double process_chunk_impl(const Index& indices) {
     const int n = indices.size();
     double res = Inf;
 
@@ -49,14 +66,6 @@ public:
     return res;
   }
 
-  inline static bool is_better(const double current, const double res) {
-    if (MINIMUM)
-      return internal::is_smaller<REALSXP>(current, res);
-    else
-      return internal::is_smaller<REALSXP>(res, current);
-  }
-
-private:
   STORAGE* data_ptr;
   bool is_summary;
 };
@@ -1,14 +1,13 @@
 #ifndef dplyr_Result_Rank_H
 #define dplyr_Result_Rank_H
 
-#include <tools/hash.h>
-
 #include <dplyr/GroupedDataFrame.h>
 
 #include <dplyr/comparisons.h>
 #include <dplyr/visitor.h>
 
 #include <dplyr/Order.h>
+#include <dplyr/SortKeys.h>
 
 #include <dplyr/Result/Result.h>
 #include <dplyr/Result/VectorSliceVisitor.h>
@@ -96,68 +95,43 @@ struct cume_dist_increment {
   }
 };
 
-}
-
-
-template <int RTYPE, bool ascending = true>
-class RankComparer {
-  typedef comparisons<RTYPE> compare;
-
-public:
-  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
+// a run of tied values, as the increments see it
+struct tied_values {
+  tied_values(int n_) : n(n_) {}
 
-  inline bool operator()(STORAGE lhs, STORAGE rhs) const {
-    return compare::is_less(lhs, rhs);
+  inline int size() const {
+    return n;
   }
-};
 
-template <int RTYPE>
-class RankComparer<RTYPE, false> {
-  typedef comparisons<RTYPE> compare;
-
-public:
-  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
-  inline bool operator()(STORAGE lhs, STORAGE rhs) const {
-    return compare::is_greater(lhs, rhs);
-  }
+  int n;
 };
 
-template <int RTYPE>
-class RankEqual {
-  typedef comparisons<RTYPE> compare;
-
-public:
-  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
+}
 
-  inline bool operator()(STORAGE lhs, STORAGE rhs) const {
-    return compare::equal_or_both_na(lhs, rhs);
-  }
-};
 
-// powers both dense_rank and min_rank, see dplyr.cpp for how it is used
+// powers both dense_rank and min_rank, see dplyr.cpp for how it is used.
+// Values are ranked on their normalized sort keys. When all the groups are
+// ranked at once, the keys are computed once for the whole vector and each
+// group is sorted without walking the values. A single slice, e.g. a group
+// of a hybrid call nested in another call, only computes the keys of its rows.
 template <int RTYPE, typename Increment, bool ascending = true>
 class Rank_Impl : public Result, public Increment {
 public:
   typedef typename Increment::OutputVector OutputVector;
-  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
-
-  typedef VectorSliceVisitor<RTYPE> Slice;
-  typedef RankComparer<RTYPE, ascending> Comparer;
-  typedef RankEqual<RTYPE> Equal;
-
-  typedef dplyr_hash_map<STORAGE, std::vector<int>, boost::hash<STORAGE>, Equal > Map;
-  typedef std::map<STORAGE, const std::vector<int>*, Comparer> oMap;
+  typedef comparisons<RTYPE> compare;
 
-  Rank_Impl(SEXP data_) : data(data_), map() {}
+  Rank_Impl(SEXP data_) : data(data_) {}
 
   virtual SEXP process(const GroupedDataFrame& gdf) {
     int ng = gdf.ngroups();
     int n  = gdf.nrows();
     if (n == 0) return IntegerVector(0);
+    SortKeys keys(data, ascending);
     GroupedDataFrame::group_iterator git = gdf.group_begin();
     OutputVector out = no_init(n);
     for (int i = 0; i < ng; i++, ++git) {
-      process_slice(out, *git);
+      const SlicingIndex& index = *git;
+      process_slice(out, index, keys, index);
     }
     return out;
   }
@@ -169,109 +143,86 @@ public:
   virtual SEXP process(const FullDataFrame& df) {
     int n = df.nrows();
     if (n == 0) return IntegerVector(0);
+    SortKeys keys(data, ascending);
     OutputVector out = no_init(n);
-    process_slice(out, df.get_index());
+    const SlicingIndex& index = df.get_index();
+    process_slice(out, index, keys, index);
     return out;
   }
 
   virtual SEXP process(const SlicingIndex& index) {
     int n = index.size();
     if (n == 0) return IntegerVector(0);
+    Vector<RTYPE> slice = wrap_subset<RTYPE>(data, index);
+    SortKeys keys(slice, ascending);
     OutputVector out = no_init(n);
-    process_slice(out, index);
+    process_slice(out, index, keys, IdentityIndex());
     return out;
   }
 
 private:
 
-  void process_slice(OutputVector& out, const SlicingIndex& index) {
-    map.clear();
-    Slice slice(data, index);
+  // the key of the j-th row of the slice is the key_index[j]-th of keys
+  template <typename Index>
+  void process_slice(OutputVector& out, const SlicingIndex& index, const SortKeys& keys, const Index& key_index) {
     int m = index.size();
+    order.resize(m);
+    for (int j = 0; j < m; j++) order[j] = j;
+    keys.sort(order, key_index);
+
+    // NA don't count in the number of ranked values
+    int n_ranked = m;
     for (int j = 0; j < m; j++) {
-      map[ slice[j] ].push_back(j);
-    }
-    STORAGE na = Rcpp::traits::get_na<RTYPE>();
-    typename Map::const_iterator it = map.find(na);
-    if (it != map.end()) {
-      m -= it->second.size();
+      if (compare::is_na(data[index[j]])) n_ranked--;
     }
 
-    oMap ordered;
-
-    it = map.begin();
-    for (; it != map.end(); ++it) {
-      ordered[it->first] = &it->second;
-    }
-    typename oMap::const_iterator oit = ordered.begin();
     typename Increment::scalar_type j = Increment::start();
-    for (; oit != ordered.end(); ++oit) {
-      STORAGE key = oit->first;
-      const std::vector<int>& chunk = *oit->second;
-      int n = chunk.size();
-      j += Increment::pre_increment(chunk, m);
-      if (Rcpp::traits::is_na<RTYPE>(key)) {
+    for (int begin = 0; begin < m;) {
+      int end = begin + 1;
+      while (end < m && keys.equal(key_index[order[begin]], key_index[order[end]])) end++;
+
+      internal::tied_values chunk(end - begin);
+      j += Increment::pre_increment(chunk, n_ranked);
+      if (Rcpp::traits::is_na<RTYPE>(data[index[order[begin]]])) {
         typename Increment::scalar_type inc_na =
           Rcpp::traits::get_na< Rcpp::traits::r_sexptype_traits<typename Increment::scalar_type>::rtype >();
-        for (int k = 0; k < n; k++) {
-          out[ chunk[k] ] = inc_na;
+        for (int k = begin; k < end; k++) {
+          out[ order[k] ] = inc_na;
         }
       } else {
-        for (int k = 0; k < n; k++) {
-          out[ chunk[k] ] = j;
+        for (int k = begin; k < end; k++) {
+          out[ order[k] ] = j;
         }
       }
-      j += Increment::post_increment(chunk, m);
+      j += Increment::post_increment(chunk, n_ranked);
+      begin = end;
     }
   }
 
 
   Vector<RTYPE> data;
-  Map map;
+  std::vector<int> order;
 };
 
 template <int RTYPE, bool ascending = true>
 class RowNumber : public Result {
 public:
-  typedef typename Rcpp::traits::storage_type<RTYPE>::type STORAGE;
-
-  typedef VectorSliceVisitor<RTYPE> Slice;
-  typedef OrderVectorVisitorImpl<RTYPE, ascending, Slice> Visitor;
-  typedef Compare_Single_OrderVisitor<Visitor> Comparer;
 
   RowNumber(SEXP data_) : data(data_) {}
 
   virtual SEXP process(const GroupedDataFrame& gdf) {
-    std::vector<int> tmp(gdf.max_group_size());
-
     int ng = gdf.ngroups();
     int n  = gdf.nrows();
     if (n == 0) return IntegerVector(0);
+    SortKeys keys(data, ascending);
     GroupedDataFrame::group_iterator git = gdf.group_begin();
     IntegerVector out(n);
     for (int i = 0; i < ng; i++, ++git) {
       const SlicingIndex& index = *git;
-
-      // tmp <- 0:(m-1)
       int m = index.size();
-      for (int j = 0; j < m; j++) tmp[j] = j;
-
-      Slice slice(data, index);
-      // order( gdf.group(i) )
-      Visitor visitor(slice);
-      Comparer comparer = Comparer(visitor);
-      std::sort(tmp.begin(), tmp.begin() + m, comparer);
-      int j = m - 1;
-      for (; j >= 0; j--) {
-        if (Rcpp::traits::is_na<RTYPE>(slice[ tmp[j] ])) {
-          m--;
-          out[ index[j] ] = NA_INTEGER;
-        } else {
-          break;
-        }
-      }
-      for (; j >= 0; j--) {
-        out[ index[j] ] = tmp[j] + 1;
+      int n_numbered = sort_slice(index, keys, index);
+      for (int j = 0; j < m; j++) {
+        out[ index[order[j]] ] = j < n_numbered ? j + 1 : NA_INTEGER;
       }
     }
     return out;
@@ -289,27 +240,34 @@ public:
   virtual SEXP process(const SlicingIndex& index) {
     int nrows = index.size();
     if (nrows == 0) return IntegerVector(0);
-    IntegerVector x = seq(0, nrows - 1);
-    Slice slice(data, index);
-    Visitor visitor(slice);
-    std::sort(x.begin(), x.end(), Comparer(visitor));
+    // only the rows of the slice get keys
+    Vector<RTYPE> slice = wrap_subset<RTYPE>(data, index);
+    int n_numbered = sort_slice(index, SortKeys(slice, ascending), IdentityIndex());
     IntegerVector out = no_init(nrows);
-    int j = nrows - 1;
-    for (; j >= 0; j--) {
-      if (Rcpp::traits::is_na<RTYPE>(slice[ x[j] ])) {
-        out[ x[j] ] = NA_INTEGER;
-      } else {
-        break;
-      }
-    }
-    for (; j >= 0; j--) {
-      out[ x[j] ] = j + 1;
+    for (int j = 0; j < nrows; j++) {
+      out[ order[j] ] = j < n_numbered ? j + 1 : NA_INTEGER;
     }
     return out;
   }
 
 private:
-  SEXP data;
+
+  // sorts the positions of the slice, ties by position, and gives the number of
+  // positions that get a number: missing values come last and get NA. The key
+  // of the j-th row of the slice is the key_index[j]-th of keys
+  template <typename Index>
+  int sort_slice(const SlicingIndex& index, const SortKeys& keys, const Index& key_index) {
+    int m = index.size();
+    order.resize(m);
+    for (int j = 0; j < m; j++) order[j] = j;
+    keys.sort(order, key_index);
+
+    while (m > 0 && Rcpp::traits::is_na<RTYPE>(data[index[order[m - 1]]])) m--;
+    return m;
+  }
+
+  Vector<RTYPE> data;
+  std::vector<int> order;
 };
 
 template <int RTYPE, bool ascending = true>
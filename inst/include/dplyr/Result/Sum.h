@@ -93,6 +93,11 @@ public:
 
   inline STORAGE process_chunk(const SlicingIndex& indices) {
     if (is_summary) return data_ptr[indices.group()];
+    if (indices.is_contiguous() && indices.size() > 0) {
+      // sequential read, no virtual dispatch per row as RangeSlicingIndex is final
+      RangeSlicingIndex range(indices[0], indices.size());
+      return internal::Sum<RTYPE, NA_RM, RangeSlicingIndex>::process(data_ptr, range);
+    }
     return internal::Sum<RTYPE, NA_RM, SlicingIndex>::process(data_ptr, indices);
   }
 
@@ -0,0 +1,189 @@
+#ifndef dplyr_SortKeys_H
+#define dplyr_SortKeys_H
+
+#include <boost/scoped_ptr.hpp>
+
+#include <tools/pointer_vector.h>
+
+#include <dplyr/OrderVisitorImpl.h>
+
+#include <cstring>
+
+namespace dplyr {
+
+// Positions of the items to sort that are rows themselves
+struct IdentityIndex {
+  inline int operator[](int i) const {
+    return i;
+  }
+};
+
+// Normalized sort keys of the rows of a set of order visitors: the radix keys
+// of the visitors, most significant byte first, laid end to end in a key of
+// the same width for all the rows. The keys of two rows compare with memcmp() as the
+// visitors compare the rows, and are equal when all the visitors are equal.
+//
+// Keys are computed once for all the rows, string ranks included, so that
+// sorting any subset of the rows, e.g. each group, neither walks the visitors
+// nor calls the R API.
+class SortKeys {
+public:
+  SortKeys(const pointer_vector<OrderVisitor>& visitors, int nrows_) :
+    width(0), nrows(nrows_)
+  {
+    int n = visitors.size();
+    for (int k = 0; k < n; k++) {
+      width += visitors[k]->radix_bytes();
+    }
+    bytes.resize((size_t)width * nrows);
+
+    for (int k = 0, offset = 0; k < n; k++) {
+      add(*visitors[k], offset);
+      offset += visitors[k]->radix_bytes();
+    }
+  }
+
+  // keys of a single vector, for the window functions
+  SortKeys(SEXP x, bool ascending) :
+    width(0), nrows(Rf_length(x))
+  {
+    boost::scoped_ptr<OrderVisitor> visitor(order_visitor(x, ascending, 0));
+    width = visitor->radix_bytes();
+    if (width == 0) stop("can't compute sort keys of a vector of type %s", Rf_type2char(TYPEOF(x)));
+    bytes.resize((size_t)width * nrows);
+    add(*visitor, 0);
+  }
+
+  // do all the visitors have radix keys
+  static bool sortable(const pointer_vector<OrderVisitor>& visitors) {
+    int n = visitors.size();
+    for (int k = 0; k < n; k++) {
+      if (visitors[k]->radix_bytes() == 0) return false;
+    }
+    return true;
+  }
+
+  inline const unsigned char* key(int i) const {
+    return &bytes[(size_t)i * width];
+  }
+
+  inline int compare(int i, int j) const {
+    return memcmp(key(i), key(j), width);
+  }
+
+  inline bool equal(int i, int j) const {
+    return compare(i, j) == 0;
+  }
+
+  inline int get_width() const {
+    return width;
+  }
+
+  // Sorts order, positions whose rows are index[order[i]], by the keys of the
+  // rows. order must be increasing: ties stay in that order. Large inputs are
+  // radix sorted, small ones compared with memcmp().
+  template <typename Index>
+  void sort(std::vector<int>& order, const Index& index) const;
+
+  inline void sort(std::vector<int>& order) const {
+    sort(order, IdentityIndex());
+  }
+
+private:
+
+  void add(const OrderVisitor& visitor, int offset) {
+    int nbytes = visitor.radix_bytes();
+    std::vector<radix_key> keys;
+    visitor.radix_keys(nrows, keys);
+
+    for (int i = 0; i < nrows; i++) {
+      unsigned char* p = &bytes[(size_t)i * width + offset];
+      radix_key k = keys[i];
+      for (int b = nbytes - 1; b >= 0; b--, k >>= 8) {
+        p[b] = (unsigned char)(k & 0xFF);
+      }
+    }
+  }
+
+  template <typename Index>
+  void sort_bytes(std::vector<int>& order, const Index& index) const;
+
+  int width;
+  int nrows;
+  std::vector<unsigned char> bytes;
+};
+
+// Compares positions by the keys of their rows, ties broken by position
+template <typename Index = IdentityIndex>
+class SortKeys_Compare {
+public:
+  SortKeys_Compare(const SortKeys& keys_, const Index& index_) : keys(keys_), index(index_) {}
+
+  inline bool operator()(int i, int j) const {
+    if (i == j) return false;
+    int cmp = keys.compare(index[i], index[j]);
+    return cmp < 0 || (cmp == 0 && i < j);
+  }
+
+private:
+  const SortKeys& keys;
+  const Index& index;
+};
+
+template <typename Index>
+inline void SortKeys::sort(std::vector<int>& order, const Index& index) const {
+  if ((int)order.size() >= DPLYR_MIN_RADIX_SORT_SIZE) {
+    sort_bytes(order, index);
+  } else {
+    std::sort(order.begin(), order.end(), SortKeys_Compare<Index>(*this, index));
+  }
+}
+
+// Stable LSD radix sort on the bytes of the keys, last byte first. The keys
+// are gathered once in the order of the rows to sort and move along with
+// them at each pass, so that all the passes read them contiguously. The
+// counts of all the bytes come from a single scan, and bytes that are the
+// same for all the rows are skipped.
+template <typename Index>
+inline void SortKeys::sort_bytes(std::vector<int>& order, const Index& index) const {
+  int m = order.size();
+  if (m < 2) return;
+
+  std::vector<unsigned char> k((size_t)m * width);
+  std::vector<int> counts(width * 256, 0);
+  for (int i = 0; i < m; i++) {
+    unsigned char* p = &k[(size_t)i * width];
+    memcpy(p, key(index[order[i]]), width);
+    for (int b = 0; b < width; b++) {
+      counts[b * 256 + p[b]]++;
+    }
+  }
+
+  std::vector<unsigned char> k_tmp((size_t)m * width);
+  std::vector<int> order_tmp(m);
+  for (int b = width - 1; b >= 0; b--) {
+    int* count = &counts[b * 256];
+
+    // nothing to do when all the rows have the same byte
+    if (count[k[b]] == m) continue;
+
+    for (int v = 0, pos = 0; v < 256; v++) {
+      int c = count[v];
+      count[v] = pos;
+      pos += c;
+    }
+
+    for (int i = 0; i < m; i++) {
+      const unsigned char* p = &k[(size_t)i * width];
+      int dest = count[p[b]]++;
+      order_tmp[dest] = order[i];
+      memcpy(&k_tmp[(size_t)dest * width], p, width);
+    }
+    order.swap(order_tmp);
+    k.swap(k_tmp);
+  }
+}
+
+}
+
+#endif
@@ -30,6 +30,14 @@ public:
   virtual std::string get_r_type() const = 0;
 
   virtual bool is_na(int i) const = 0;
+
+  /** computes up front what less() and greater() compute on first use, so that they can be called on several threads */
+  virtual void provide_orders() const {}
+
+  /** can hash() and equal() be called on several threads, i.e. do they read the data without the R API */
+  virtual bool thread_safe() const {
+    return false;
+  }
 };
 
 } // namespace dplyr
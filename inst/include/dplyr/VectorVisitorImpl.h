@@ -87,6 +87,11 @@ public:
     return VECTOR::is_na(vec[i]);
   }
 
+  // the elements of lists are read with VECTOR_ELT()
+  bool thread_safe() const {
+    return RTYPE != VECSXP;
+  }
+
 protected:
   VECTOR vec;
   hasher hash_fun;
@@ -175,11 +180,6 @@ public:
     return CharacterVector::is_na(vec[i]);
   }
 
-private:
-  SEXP get_item(const int i) const {
-    return static_cast<SEXP>(vec[i]);
-  }
-
   void provide_orders() const {
     if (has_orders)
       return;
@@ -188,6 +188,11 @@ private:
     has_orders = true;
   }
 
+private:
+  SEXP get_item(const int i) const {
+    return static_cast<SEXP>(vec[i]);
+  }
+
 private:
   CharacterVector vec;
   mutable IntegerVector orders;
@@ -9,6 +9,26 @@
 #define DPLYR_INTERUPT_TIMES 10
 #endif
 
+#ifndef DPLYR_MIN_PARALLEL_SIZE
+#define DPLYR_MIN_PARALLEL_SIZE 100000
+#endif
+
+#ifndef DPLYR_MIN_COUNTING_SORT_RANGE
+#define DPLYR_MIN_COUNTING_SORT_RANGE 1024
+#endif
+
+#ifndef DPLYR_MIN_RADIX_SORT_SIZE
+#define DPLYR_MIN_RADIX_SORT_SIZE 1024
+#endif
+
+#ifndef DPLYR_JOIN_PARTITION_SIZE
+#define DPLYR_JOIN_PARTITION_SIZE 32768
+#endif
+
+#ifndef DPLYR_JOIN_BLOOM_PROBES
+#define DPLYR_JOIN_BLOOM_PROBES 3
+#endif
+
 #endif
 
 
@@ -0,0 +1,25 @@
+#ifndef dplyr_group_cache_H
+#define dplyr_group_cache_H
+
+#include <tools/SymbolVector.h>
+
+namespace dplyr {
+
+// Cache of group indices, opt-in through the `dplyr.group_cache_size` option.
+// Entries are keyed on the addresses of the grouping columns, their names,
+// the number of rows, whether the groups are ordered and the collation of
+// strings, which orders the labels (see collate_bytes()). The cache keeps the
+// columns alive and marks them as shared, so an address can't be reused and
+// a modified column gets a new one.
+
+// true and sets rows, offsets and labels if the index of these grouping columns is cached
+bool group_cache_lookup(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+                        IntegerVector& rows, IntegerVector& offsets, DataFrame& labels);
+
+// adds an index to the cache, evicting the least recently used entries to stay within the budget
+void group_cache_insert(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+                        const IntegerVector& rows, const IntegerVector& offsets, const DataFrame& labels);
+
+}
+
+#endif
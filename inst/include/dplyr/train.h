@@ -1,6 +1,10 @@
 #ifndef dplyr_train_h
 #define dplyr_train_h
 
+#include <tools/threads.h>
+
+#include <dplyr/JoinHashTable.h>
+
 namespace dplyr {
 
 template <typename Op>
@@ -40,6 +44,48 @@ inline void train_push_back(Map& map, int n) {
   iterate_with_interupts(push_back_op<Map>(map), n);
 }
 
+// Trains hash tables on the n rows on nthreads threads, for visitors that are
+// thread_safe(). The rows are partitioned by the hash of their keys, so that all
+// the rows of a group fall in the same partition, and each thread builds the
+// tables of its partitions. The groups of different tables are distinct, so
+// they need no merging. The rows of each group are in ascending order, as with
+// train_push_back().
+template <typename VisitorSet>
+inline void train_hash_tables_parallel(VisitorSet& visitors, int n, int nthreads,
+                                       std::vector<JoinHashTableData>& tables) {
+  std::vector<size_t> hashes(n);
+
+  #pragma omp parallel for num_threads(nthreads) schedule(static)
+  for (int i = 0; i < n; i++) {
+    hashes[i] = visitors.hash(i);
+  }
+
+  std::vector<int> offsets, rows;
+  std::vector<size_t> part_hashes;
+  int npartitions = hash_partitions(n, nthreads);
+  partition_rows(hashes, npartitions, offsets, rows, part_hashes);
+  tables.resize(npartitions);
+
+  // the worker threads can't throw: running out of memory is reported after the loop
+  bool out_of_memory = false;
+
+  #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+  for (int p = 0; p < npartitions; p++) {
+    int begin = offsets[p];
+    int m = offsets[p + 1] - begin;
+    if (m == 0) continue;
+
+    try {
+      JoinHashTable<VisitorSet> table(visitors, tables[p]);
+      table.build(m, false, &rows[begin], &part_hashes[begin]);
+    } catch (const std::bad_alloc&) {
+      #pragma omp critical
+      out_of_memory = true;
+    }
+  }
+  if (out_of_memory) throw std::bad_alloc();
+}
+
 template <typename Map>
 inline void train_push_back_right(Map& map, int n) {
   iterate_with_interupts(push_back_right_op<Map>(map), n);
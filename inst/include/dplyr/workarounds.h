@@ -7,4 +7,11 @@
 #define Rf_installChar installChar
 #endif
 
+// final is C++11, classes marked DPLYR_FINAL are only final when it is available
+#if __cplusplus >= 201103L
+#define DPLYR_FINAL final
+#else
+#define DPLYR_FINAL
+#endif
+
 #endif
@@ -1,6 +1,8 @@
 #ifndef dplyr_tools_SlicingIndex_H
 #define dplyr_tools_SlicingIndex_H
 
+#include <dplyr/workarounds.h>
+
 // A SlicingIndex allows specifying which rows of a data frame are selected in which order, basically a 0:n -> 0:m map.
 // It also can be used to split a data frame in groups.
 // Important special cases can be implemented without materializing the map.
@@ -12,6 +14,10 @@ public:
   virtual bool is_identity(SEXP) const {
     return FALSE;
   };
+  // true if the selected rows are consecutive, i.e. if (*this)[i] == (*this)[0] + i
+  virtual bool is_contiguous() const {
+    return false;
+  }
 };
 
 // A GroupedSlicingIndex is the most general slicing index,
@@ -40,6 +46,63 @@ private:
   int group_index;
 };
 
+// A FlatGroupedSlicingIndex is a view on the rows of one group in the flat row id vector
+// of a grouped data frame, where the rows of all groups are stored one after the other.
+// It neither owns nor allocates memory, the row ids must outlive it.
+// It is used to iterate over the groups of a GroupedDataFrame.
+// It is final, so that loops templated on it call its members without virtual dispatch.
+class FlatGroupedSlicingIndex DPLYR_FINAL : public SlicingIndex {
+public:
+  FlatGroupedSlicingIndex(const int* rows_, int n_, int group_) : rows(rows_), n(n_), group_index(group_) {}
+
+  inline int size() const {
+    return n;
+  }
+
+  inline int operator[](int i) const {
+    return rows[i];
+  }
+
+  inline int group() const {
+    return group_index;
+  }
+
+private:
+  const int* rows;
+  int n;
+  int group_index;
+};
+
+// A RangeSlicingIndex selects the consecutive rows start, ..., start + n - 1.
+// It is used for the groups of a data frame that is sorted by its grouping variables,
+// processors can then read the data sequentially instead of gathering rows.
+// Being final, its members are called directly in the loops templated on it.
+class RangeSlicingIndex DPLYR_FINAL : public SlicingIndex {
+public:
+  RangeSlicingIndex(int start_, int n_, int group_ = -1) : start(start_), n(n_), group_index(group_) {}
+
+  inline int size() const {
+    return n;
+  }
+
+  inline int operator[](int i) const {
+    return start + i;
+  }
+
+  inline int group() const {
+    return group_index;
+  }
+
+  inline bool is_contiguous() const {
+    return true;
+  }
+
+private:
+  int start;
+  int n;
+  int group_index;
+};
+
 // A RowwiseSlicingIndex selects a single row, which is also the group ID by definition.
 // It is used in rowwise operations (rowwise()).
 class RowwiseSlicingIndex : public SlicingIndex {
@@ -60,6 +123,10 @@ public:
     return start;
   }
 
+  inline bool is_contiguous() const {
+    return true;
+  }
+
 private:
   int start;
 };
@@ -90,6 +157,10 @@ public:
     return length == n;
   }
 
+  virtual bool is_contiguous() const {
+    return true;
+  }
+
 private:
   int n;
 };
@@ -114,6 +185,10 @@ public:
     return -1;
   }
 
+  inline bool is_contiguous() const {
+    return true;
+  }
+
 private:
   int start, n;
 };
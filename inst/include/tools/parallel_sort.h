@@ -0,0 +1,88 @@
+#ifndef dplyr_tools_parallel_sort_H
+#define dplyr_tools_parallel_sort_H
+
+#include <tools/threads.h>
+
+namespace dplyr {
+
+// Number of the first k elements of the stable merge of a[0, na) and b[0, nb)
+// that come from a.
+template <typename Iterator, typename Compare>
+int merge_split(Iterator a, int na, Iterator b, int nb, int k, Compare comp) {
+  int lo = std::max(0, k - nb), hi = std::min(k, na);
+  while (lo < hi) {
+    int i = lo + (hi - lo) / 2;
+    int j = k - i;
+    // a[i] comes before b[j - 1] in the merge, so more than i elements come from a
+    if (!comp(b[j - 1], a[i])) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+// Stable sort of x by comp on nthreads threads: consecutive chunks of x are
+// sorted on their own thread, then merged pairwise in rounds. Each merge of a
+// round is split in parts of about the same size, so that all the threads
+// keep busy until the last merge.
+//
+// comp is called on the worker threads, so it must not call the R API.
+template <typename T, typename Compare>
+void parallel_stable_sort(std::vector<T>& x, Compare comp, int nthreads) {
+  int n = x.size();
+  if (nthreads <= 1 || n < 2 * nthreads) {
+    std::stable_sort(x.begin(), x.end(), comp);
+    return;
+  }
+
+  int nchunks = nthreads;
+  std::vector<int> bounds(nchunks + 1);
+  for (int c = 0; c <= nchunks; c++) {
+    bounds[c] = chunk_begin(c, nchunks, n);
+  }
+
+  #pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+  for (int c = 0; c < nchunks; c++) {
+    std::stable_sort(x.begin() + bounds[c], x.begin() + bounds[c + 1], comp);
+  }
+
+  std::vector<T> buffer(n);
+  std::vector<T>* from = &x;
+  std::vector<T>* to = &buffer;
+
+  for (int width = 1; width < nchunks; width *= 2) {
+    int nmerges = (nchunks + 2 * width - 1) / (2 * width);
+    int nparts = std::max(1, nthreads / nmerges);
+
+    #pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+    for (int task = 0; task < nmerges * nparts; task++) {
+      int m = task / nparts, part = task % nparts;
+      int lo = bounds[std::min(2 * m * width, nchunks)];
+      int mid = bounds[std::min((2 * m + 1) * width, nchunks)];
+      int hi = bounds[std::min((2 * m + 2) * width, nchunks)];
+
+      typename std::vector<T>::iterator a = from->begin() + lo, b = from->begin() + mid;
+      int na = mid - lo, nb = hi - mid;
+
+      // the part of the merged output this task writes, and where its inputs start and end
+      int k_begin = chunk_begin(part, nparts, na + nb), k_end = chunk_begin(part + 1, nparts, na + nb);
+      int i_begin = merge_split(a, na, b, nb, k_begin, comp);
+      int i_end = merge_split(a, na, b, nb, k_end, comp);
+
+      std::merge(
+        a + i_begin, a + i_end,
+        b + (k_begin - i_begin), b + (k_end - i_end),
+        to->begin() + lo + k_begin, comp
+      );
+    }
+    std::swap(from, to);
+  }
+
+  if (from != &x) x.swap(buffer);
+}
+
+}
+
+#endif
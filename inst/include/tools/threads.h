@@ -0,0 +1,42 @@
+#ifndef dplyr_tools_threads_H
+#define dplyr_tools_threads_H
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace dplyr {
+
+// Number of threads used by the parallel algorithms, from the
+// `dplyr.threads` option. Always 1 when dplyr is compiled without OpenMP.
+//
+// Code running on the worker threads must not call the R API, nor throw.
+inline int get_nthreads() {
+#ifdef _OPENMP
+  SEXP option = Rf_GetOption1(Rf_install("dplyr.threads"));
+  if (!Rf_isNumeric(option) || Rf_length(option) != 1) return 1;
+
+  int n = Rf_asInteger(option);
+  if (n == NA_INTEGER || n < 1) return 1;
+  return std::min(n, omp_get_num_procs());
+#else
+  return 1;
+#endif
+}
+
+// Number of threads to use for n items, so that each thread gets
+// at least DPLYR_MIN_PARALLEL_SIZE items.
+inline int get_nthreads(int n) {
+  int nthreads = get_nthreads();
+  if (nthreads == 1 || n < 2 * DPLYR_MIN_PARALLEL_SIZE) return 1;
+  return std::max(1, std::min(nthreads, n / DPLYR_MIN_PARALLEL_SIZE));
+}
+
+// Bounds of the i-th of nchunks consecutive chunks of [0, n)
+inline int chunk_begin(int i, int nchunks, int n) {
+  return (int)(((double)n * i) / nchunks);
+}
+
+}
+
+#endif
@@ -9,6 +9,8 @@ SEXP shallow_copy(const List& data);
 SEXP pairlist_shallow_copy(SEXP p);
 void copy_attributes(SEXP out, SEXP data);
 void strip_index(DataFrame x);
+void set_index(DataFrame x, const IntegerVector& rows, const IntegerVector& offsets, const DataFrame& labels);
+bool has_ordered_groups(const DataFrame& data);
 SEXP null_if_empty(SEXP x);
 
 bool is_vector(SEXP x);
@@ -35,6 +37,8 @@ SEXP set_levels(SEXP x, const CharacterVector& levels);
 bool same_levels(SEXP left, SEXP right);
 bool character_vector_equal(const CharacterVector& x, const CharacterVector& y);
 
+void order_groups_by_first_row(IntegerVector& rows, IntegerVector& offsets, DataFrame& labels);
+
 SymbolVector get_vars(SEXP x, bool duplicate = false);
 void set_vars(SEXP x, const SymbolVector& vars);
 void copy_vars(SEXP target, SEXP source);
@@ -193,16 +193,31 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// filter_top_n_impl
+SEXP filter_top_n_impl(DataFrame df, const SymbolVector& var, int n, bool descending);
+RcppExport SEXP _dplyr_filter_top_n_impl(SEXP dfSEXP, SEXP varSEXP, SEXP nSEXP, SEXP descendingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type df(dfSEXP);
+    Rcpp::traits::input_parameter< const SymbolVector& >::type var(varSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< bool >::type descending(descendingSEXP);
+    rcpp_result_gen = Rcpp::wrap(filter_top_n_impl(df, var, n, descending));
+    return rcpp_result_gen;
+END_RCPP
+}
 // grouped_df_impl
-DataFrame grouped_df_impl(DataFrame data, SymbolVector symbols, bool drop);
-RcppExport SEXP _dplyr_grouped_df_impl(SEXP dataSEXP, SEXP symbolsSEXP, SEXP dropSEXP) {
+DataFrame grouped_df_impl(DataFrame data, SymbolVector symbols, bool drop, bool ordered);
+RcppExport SEXP _dplyr_grouped_df_impl(SEXP dataSEXP, SEXP symbolsSEXP, SEXP dropSEXP, SEXP orderedSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< DataFrame >::type data(dataSEXP);
     Rcpp::traits::input_parameter< SymbolVector >::type symbols(symbolsSEXP);
     Rcpp::traits::input_parameter< bool >::type drop(dropSEXP);
-    rcpp_result_gen = Rcpp::wrap(grouped_df_impl(data, symbols, drop));
+    Rcpp::traits::input_parameter< bool >::type ordered(orderedSEXP);
+    rcpp_result_gen = Rcpp::wrap(grouped_df_impl(data, symbols, drop, ordered));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -239,6 +254,25 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// group_cache_info
+List group_cache_info();
+RcppExport SEXP _dplyr_group_cache_info() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(group_cache_info());
+    return rcpp_result_gen;
+END_RCPP
+}
+// group_cache_clear
+void group_cache_clear();
+RcppExport SEXP _dplyr_group_cache_clear() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    group_cache_clear();
+    return R_NilValue;
+END_RCPP
+}
 // grouped_indices_grouped_df_impl
 IntegerVector grouped_indices_grouped_df_impl(GroupedDataFrame gdf);
 RcppExport SEXP _dplyr_grouped_indices_grouped_df_impl(SEXP gdfSEXP) {
@@ -261,6 +295,30 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// group_index_list
+List group_index_list(GroupedDataFrame gdf);
+RcppExport SEXP _dplyr_group_index_list(SEXP gdfSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< GroupedDataFrame >::type gdf(gdfSEXP);
+    rcpp_result_gen = Rcpp::wrap(group_index_list(gdf));
+    return rcpp_result_gen;
+END_RCPP
+}
+// group_ids_impl
+IntegerVector group_ids_impl(DataFrame data, SymbolVector vars, bool sorted);
+RcppExport SEXP _dplyr_group_ids_impl(SEXP dataSEXP, SEXP varsSEXP, SEXP sortedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< SymbolVector >::type vars(varsSEXP);
+    Rcpp::traits::input_parameter< bool >::type sorted(sortedSEXP);
+    rcpp_result_gen = Rcpp::wrap(group_ids_impl(data, vars, sorted));
+    return rcpp_result_gen;
+END_RCPP
+}
 // get_date_classes
 SEXP get_date_classes();
 static SEXP _dplyr_get_date_classes_try() {
@@ -350,8 +408,8 @@ RcppExport SEXP _dplyr_build_index_cpp(SEXP dataSEXP) {
     return rcpp_result_gen;
 }
 // semi_join_impl
-DataFrame semi_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match);
-RcppExport SEXP _dplyr_semi_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP na_matchSEXP) {
+DataFrame semi_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_semi_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -360,13 +418,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< CharacterVector >::type by_x(by_xSEXP);
     Rcpp::traits::input_parameter< CharacterVector >::type by_y(by_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(semi_join_impl(x, y, by_x, by_y, na_match));
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(semi_join_impl(x, y, by_x, by_y, na_match, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // anti_join_impl
-DataFrame anti_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match);
-RcppExport SEXP _dplyr_anti_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP na_matchSEXP) {
+DataFrame anti_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_anti_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -375,13 +434,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< CharacterVector >::type by_x(by_xSEXP);
     Rcpp::traits::input_parameter< CharacterVector >::type by_y(by_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(anti_join_impl(x, y, by_x, by_y, na_match));
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(anti_join_impl(x, y, by_x, by_y, na_match, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // inner_join_impl
-DataFrame inner_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match);
-RcppExport SEXP _dplyr_inner_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
+DataFrame inner_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_inner_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -392,13 +452,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
     Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(inner_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match));
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(inner_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // left_join_impl
-DataFrame left_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match);
-RcppExport SEXP _dplyr_left_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
+DataFrame left_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_left_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -409,13 +470,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
     Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(left_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match));
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(left_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // right_join_impl
-DataFrame right_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match);
-RcppExport SEXP _dplyr_right_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
+DataFrame right_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_right_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -426,13 +488,32 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
     Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(right_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match));
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(right_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // full_join_impl
-DataFrame full_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match);
-RcppExport SEXP _dplyr_full_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
+DataFrame full_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, std::string& suffix_x, std::string& suffix_y, bool na_match, const std::string& method);
+RcppExport SEXP _dplyr_full_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP, SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type x(xSEXP);
+    Rcpp::traits::input_parameter< DataFrame >::type y(ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type by_x(by_xSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type by_y(by_ySEXP);
+    Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
+    Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
+    Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(full_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match, method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// asof_join_impl
+DataFrame asof_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, CharacterVector on_x, CharacterVector on_y, const std::string& direction, double tolerance, std::string& suffix_x, std::string& suffix_y, bool na_match);
+RcppExport SEXP _dplyr_asof_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP on_xSEXP, SEXP on_ySEXP, SEXP directionSEXP, SEXP toleranceSEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -440,10 +521,88 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< DataFrame >::type y(ySEXP);
     Rcpp::traits::input_parameter< CharacterVector >::type by_x(by_xSEXP);
     Rcpp::traits::input_parameter< CharacterVector >::type by_y(by_ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type on_x(on_xSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type on_y(on_ySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type direction(directionSEXP);
+    Rcpp::traits::input_parameter< double >::type tolerance(toleranceSEXP);
     Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
     Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
     Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
-    rcpp_result_gen = Rcpp::wrap(full_join_impl(x, y, by_x, by_y, suffix_x, suffix_y, na_match));
+    rcpp_result_gen = Rcpp::wrap(asof_join_impl(x, y, by_x, by_y, on_x, on_y, direction, tolerance, suffix_x, suffix_y, na_match));
+    return rcpp_result_gen;
+END_RCPP
+}
+// inequality_join_impl
+DataFrame inequality_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, CharacterVector on_x, CharacterVector on_y, CharacterVector ops, bool keep_unmatched, std::string& suffix_x, std::string& suffix_y, bool na_match);
+RcppExport SEXP _dplyr_inequality_join_impl(SEXP xSEXP, SEXP ySEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP on_xSEXP, SEXP on_ySEXP, SEXP opsSEXP, SEXP keep_unmatchedSEXP, SEXP suffix_xSEXP, SEXP suffix_ySEXP, SEXP na_matchSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type x(xSEXP);
+    Rcpp::traits::input_parameter< DataFrame >::type y(ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type by_x(by_xSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type by_y(by_ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type on_x(on_xSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type on_y(on_ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type ops(opsSEXP);
+    Rcpp::traits::input_parameter< bool >::type keep_unmatched(keep_unmatchedSEXP);
+    Rcpp::traits::input_parameter< std::string& >::type suffix_x(suffix_xSEXP);
+    Rcpp::traits::input_parameter< std::string& >::type suffix_y(suffix_ySEXP);
+    Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
+    rcpp_result_gen = Rcpp::wrap(inequality_join_impl(x, y, by_x, by_y, on_x, on_y, ops, keep_unmatched, suffix_x, suffix_y, na_match));
+    return rcpp_result_gen;
+END_RCPP
+}
+// star_join_impl
+DataFrame star_join_impl(DataFrame x, List dims, List by_x, List by_y, CharacterVector suffixes, bool na_match);
+RcppExport SEXP _dplyr_star_join_impl(SEXP xSEXP, SEXP dimsSEXP, SEXP by_xSEXP, SEXP by_ySEXP, SEXP suffixesSEXP, SEXP na_matchSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type x(xSEXP);
+    Rcpp::traits::input_parameter< List >::type dims(dimsSEXP);
+    Rcpp::traits::input_parameter< List >::type by_x(by_xSEXP);
+    Rcpp::traits::input_parameter< List >::type by_y(by_ySEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type suffixes(suffixesSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
+    rcpp_result_gen = Rcpp::wrap(star_join_impl(x, dims, by_x, by_y, suffixes, na_match));
+    return rcpp_result_gen;
+END_RCPP
+}
+// key_index_impl
+DataFrame key_index_impl(DataFrame data, const SymbolVector& vars);
+RcppExport SEXP _dplyr_key_index_impl(SEXP dataSEXP, SEXP varsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const SymbolVector& >::type vars(varsSEXP);
+    rcpp_result_gen = Rcpp::wrap(key_index_impl(data, vars));
+    return rcpp_result_gen;
+END_RCPP
+}
+// key_index_vars_impl
+SEXP key_index_vars_impl(DataFrame data);
+RcppExport SEXP _dplyr_key_index_vars_impl(SEXP dataSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type data(dataSEXP);
+    rcpp_result_gen = Rcpp::wrap(key_index_vars_impl(data));
+    return rcpp_result_gen;
+END_RCPP
+}
+// filter_key_index_impl
+SEXP filter_key_index_impl(DataFrame df, const SymbolVector& var, SEXP values, bool na_match);
+RcppExport SEXP _dplyr_filter_key_index_impl(SEXP dfSEXP, SEXP varSEXP, SEXP valuesSEXP, SEXP na_matchSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type df(dfSEXP);
+    Rcpp::traits::input_parameter< const SymbolVector& >::type var(varSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_match(na_matchSEXP);
+    rcpp_result_gen = Rcpp::wrap(filter_key_index_impl(df, var, values, na_match));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -695,21 +854,32 @@ static const R_CallMethodDef CallEntries[] = {
     {"_dplyr_distinct_impl", (DL_FUNC) &_dplyr_distinct_impl, 3},
     {"_dplyr_n_distinct_multi", (DL_FUNC) &_dplyr_n_distinct_multi, 2},
     {"_dplyr_filter_impl", (DL_FUNC) &_dplyr_filter_impl, 2},
-    {"_dplyr_grouped_df_impl", (DL_FUNC) &_dplyr_grouped_df_impl, 3},
+    {"_dplyr_filter_top_n_impl", (DL_FUNC) &_dplyr_filter_top_n_impl, 4},
+    {"_dplyr_grouped_df_impl", (DL_FUNC) &_dplyr_grouped_df_impl, 4},
     {"_dplyr_as_regular_df", (DL_FUNC) &_dplyr_as_regular_df, 1},
     {"_dplyr_ungroup_grouped_df", (DL_FUNC) &_dplyr_ungroup_grouped_df, 1},
     {"_dplyr_test_grouped_df", (DL_FUNC) &_dplyr_test_grouped_df, 1},
+    {"_dplyr_group_cache_info", (DL_FUNC) &_dplyr_group_cache_info, 0},
+    {"_dplyr_group_cache_clear", (DL_FUNC) &_dplyr_group_cache_clear, 0},
     {"_dplyr_grouped_indices_grouped_df_impl", (DL_FUNC) &_dplyr_grouped_indices_grouped_df_impl, 1},
     {"_dplyr_group_size_grouped_cpp", (DL_FUNC) &_dplyr_group_size_grouped_cpp, 1},
+    {"_dplyr_group_index_list", (DL_FUNC) &_dplyr_group_index_list, 1},
+    {"_dplyr_group_ids_impl", (DL_FUNC) &_dplyr_group_ids_impl, 3},
     {"_dplyr_get_date_classes", (DL_FUNC) &_dplyr_get_date_classes, 0},
     {"_dplyr_get_time_classes", (DL_FUNC) &_dplyr_get_time_classes, 0},
     {"_dplyr_build_index_cpp", (DL_FUNC) &_dplyr_build_index_cpp, 1},
-    {"_dplyr_semi_join_impl", (DL_FUNC) &_dplyr_semi_join_impl, 5},
-    {"_dplyr_anti_join_impl", (DL_FUNC) &_dplyr_anti_join_impl, 5},
-    {"_dplyr_inner_join_impl", (DL_FUNC) &_dplyr_inner_join_impl, 7},
-    {"_dplyr_left_join_impl", (DL_FUNC) &_dplyr_left_join_impl, 7},
-    {"_dplyr_right_join_impl", (DL_FUNC) &_dplyr_right_join_impl, 7},
-    {"_dplyr_full_join_impl", (DL_FUNC) &_dplyr_full_join_impl, 7},
+    {"_dplyr_semi_join_impl", (DL_FUNC) &_dplyr_semi_join_impl, 6},
+    {"_dplyr_anti_join_impl", (DL_FUNC) &_dplyr_anti_join_impl, 6},
+    {"_dplyr_inner_join_impl", (DL_FUNC) &_dplyr_inner_join_impl, 8},
+    {"_dplyr_left_join_impl", (DL_FUNC) &_dplyr_left_join_impl, 8},
+    {"_dplyr_right_join_impl", (DL_FUNC) &_dplyr_right_join_impl, 8},
+    {"_dplyr_full_join_impl", (DL_FUNC) &_dplyr_full_join_impl, 8},
+    {"_dplyr_asof_join_impl", (DL_FUNC) &_dplyr_asof_join_impl, 11},
+    {"_dplyr_inequality_join_impl", (DL_FUNC) &_dplyr_inequality_join_impl, 11},
+    {"_dplyr_star_join_impl", (DL_FUNC) &_dplyr_star_join_impl, 6},
+    {"_dplyr_key_index_impl", (DL_FUNC) &_dplyr_key_index_impl, 2},
+    {"_dplyr_key_index_vars_impl", (DL_FUNC) &_dplyr_key_index_vars_impl, 1},
+    {"_dplyr_filter_key_index_impl", (DL_FUNC) &_dplyr_filter_key_index_impl, 4},
     {"_dplyr_mutate_impl", (DL_FUNC) &_dplyr_mutate_impl, 2},
     {"_dplyr_select_impl", (DL_FUNC) &_dplyr_select_impl, 2},
     {"_dplyr_compatible_data_frame_nonames", (DL_FUNC) &_dplyr_compatible_data_frame_nonames, 3},
@@ -5,6 +5,10 @@
 
 #include <tools/hash.h>
 #include <tools/match.h>
+#include <tools/parallel_sort.h>
+
+#include <clocale>
+#include <cstring>
 
 #include <dplyr/CharacterVectorOrderer.h>
 
@@ -92,6 +96,68 @@ DataFrameJoinVisitors::DataFrameJoinVisitors(const DataFrame& left_, const DataF
   }
 }
 
+// Orders strings as sort() does, by Scollate(): by their bytes in the C
+// locale, else by the collation rules of the locale. Strings that collate
+// equal are ordered by their bytes.
+struct StringCollate {
+  inline bool operator()(SEXP x, SEXP y) const {
+    int cmp = Scollate(x, y);
+    return cmp < 0 || (cmp == 0 && strcmp(CHAR(x), CHAR(y)) < 0);
+  }
+};
+
+// Orders the strings of the index positions by their UTF-8 bytes, without
+// the R API, so that it can sort on several threads
+struct StringBytesLess {
+  StringBytesLess(const std::vector<const char*>& chars_) : chars(chars_) {}
+
+  inline bool operator()(int i, int j) const {
+    return strcmp(chars[i], chars[j]) < 0;
+  }
+
+  const std::vector<const char*>& chars;
+};
+
+bool collate_bytes() {
+  SEXP option = Rf_GetOption1(Rf_install("dplyr.collation"));
+  if (TYPEOF(option) == STRSXP && Rf_length(option) == 1 && STRING_ELT(option, 0) != NA_STRING) {
+    const char* collation = CHAR(STRING_ELT(option, 0));
+    if (strcmp(collation, "C") == 0) return true;
+    if (strcmp(collation, "locale") != 0) {
+      stop("`dplyr.collation` must be \"locale\" or \"C\", not \"%s\"", collation);
+    }
+  }
+
+  const char* locale = setlocale(LC_COLLATE, NULL);
+  return locale && (strcmp(locale, "C") == 0 || strcmp(locale, "POSIX") == 0);
+}
+
+// Sorts strings without NA, in C++
+static void sort_strings(std::vector<SEXP>& strings) {
+  int n = strings.size();
+  if (n < 2) return;
+
+  if (!collate_bytes()) {
+    std::sort(strings.begin(), strings.end(), StringCollate());
+    return;
+  }
+
+  // the bytes are retrieved first, so that the sort itself doesn't call the R API
+  std::vector<const char*> chars(n);
+  std::vector<int> index(n);
+  for (int i = 0; i < n; i++) {
+    chars[i] = Rf_translateCharUTF8(strings[i]);
+    index[i] = i;
+  }
+  parallel_stable_sort(index, StringBytesLess(chars), get_nthreads(n));
+
+  std::vector<SEXP> sorted(n);
+  for (int i = 0; i < n; i++) {
+    sorted[i] = strings[index[i]];
+  }
+  strings.swap(sorted);
+}
+
 CharacterVectorOrderer::CharacterVectorOrderer(const CharacterVector& data) :
   orders(no_init(data.size()))
 {
@@ -115,21 +181,23 @@ CharacterVectorOrderer::CharacterVectorOrderer(const CharacterVector& data) :
     previous = s;
   }
 
-  // retrieve unique strings from the set
+  // retrieve unique strings from the set, NA aside: it ranks as NA
   int n_uniques = set.size();
   LOG_VERBOSE << "Sorting " <<  n_uniques << " unique character elements";
 
-  CharacterVector uniques(set.begin(), set.end());
-  CharacterVector s_uniques = Language("sort", uniques).fast_eval();
-
-  // order the uniques with a callback to R
-  IntegerVector o = r_match(uniques, s_uniques);
+  std::vector<SEXP> uniques;
+  uniques.reserve(n_uniques);
+  for (dplyr_hash_set<SEXP>::const_iterator it = set.begin(); it != set.end(); ++it) {
+    if (*it != NA_STRING) uniques.push_back(*it);
+  }
+  sort_strings(uniques);
 
-  // combine uniques and o into a hash map for fast retrieval
+  // combine uniques and their ranks into a hash map for fast retrieval
   dplyr_hash_map<SEXP, int> map(n_uniques);
-  for (int i = 0; i < n_uniques; i++) {
-    map.insert(std::make_pair(uniques[i], o[i]));
+  for (int i = 0; i < (int)uniques.size(); i++) {
+    map.insert(std::make_pair(uniques[i], i + 1));
   }
+  map.insert(std::make_pair(NA_STRING, NA_INTEGER));
 
   // grab min ranks
   p_data = Rcpp::internal::r_vector_start<STRSXP>(data);
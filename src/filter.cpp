@@ -7,6 +7,8 @@
 #include <tools/SymbolString.h>
 
 #include <dplyr/GroupedDataFrame.h>
+#include <dplyr/CharacterVectorOrderer.h>
+#include <dplyr/RadixSort.h>
 
 #include <dplyr/Result/LazyRowwiseSubsets.h>
 #include <dplyr/Result/GroupedCallProxy.h>
@@ -38,6 +40,59 @@ SEXP check_result_lgl_type(SEXP tmp) {
   return tmp;
 }
 
+// the groups of the result are the groups of gdf minus the rows that were
+// filtered out, so the new index is derived from the old one without hashing
+inline void filter_index(DataFrame& res, const GroupedDataFrame& gdf, const LogicalVector& test) {
+  const int n = test.size();
+  const int* p_test = Rcpp::internal::r_vector_start<LGLSXP>(test);
+
+  // new position of each row that is kept, -1 for the others
+  std::vector<int> new_rows(n);
+  int nkept = 0;
+  for (int i = 0; i < n; i++) {
+    new_rows[i] = p_test[i] == TRUE ? nkept++ : -1;
+  }
+
+  const int ngroups = gdf.ngroups();
+  const int* old_rows = Rcpp::internal::r_vector_start<INTSXP>(gdf.rows());
+  const int* old_offsets = Rcpp::internal::r_vector_start<INTSXP>(gdf.offsets());
+
+  IntegerVector rows = no_init(nkept);
+  std::vector<int> offsets;
+  offsets.reserve(ngroups + 1);
+  offsets.push_back(0);
+  std::vector<int> kept_groups;
+  kept_groups.reserve(ngroups);
+
+  int k = 0;
+  for (int g = 0; g < ngroups; g++) {
+    for (int j = old_offsets[g]; j < old_offsets[g + 1]; j++) {
+      int row = new_rows[old_rows[j]];
+      if (row >= 0) rows[k++] = row;
+    }
+    // groups that became empty are dropped
+    if (k > offsets.back()) {
+      kept_groups.push_back(g);
+      offsets.push_back(k);
+    }
+  }
+
+  DataFrame old_labels(gdf.data().attr("labels"));
+  DataFrame labels = DataFrameSubsetVisitors(old_labels).subset(kept_groups, "data.frame");
+  IntegerVector new_offsets = wrap(offsets);
+
+  // a group of unordered data may have lost its first rows, so the
+  // surviving groups have to be put back in the order of their first row
+  if (!has_ordered_groups(gdf.data())) {
+    order_groups_by_first_row(rows, new_offsets, labels);
+  }
+  set_index(res, rows, new_offsets, labels);
+}
+
+inline void filter_index(DataFrame& res, const RowwiseDataFrame&, const LogicalVector&) {
+  strip_index(res);
+}
+
 template <typename SlicedTibble, typename Subsets>
 DataFrame filter_grouped(const SlicedTibble& gdf, const NamedQuosure& quo) {
   typedef GroupedCallProxy<SlicedTibble, Subsets> Proxy;
@@ -70,7 +125,7 @@ DataFrame filter_grouped(const SlicedTibble& gdf, const NamedQuosure& quo) {
   // Subset the grouped data frame
   DataFrame res = subset(data, test, data.names(), classes_grouped<SlicedTibble>());
   copy_vars(res, data);
-  strip_index(res);
+  filter_index(res, gdf, test);
   return SlicedTibble(res).data();
 }
 
@@ -106,3 +161,118 @@ SEXP filter_impl(DataFrame df, NamedQuosure quo) {
     return filter_ungrouped(df, quo);
   }
 }
+
+// Keys of the values of a vector that order them as min_rank() does, read
+// on the fly: the radix keys of the values, NA and NaN aside
+template <int RTYPE, bool ascending>
+class TopNKeys {
+public:
+  TopNKeys(SEXP x) : vec(x) {}
+
+  inline bool is_na(int i) const {
+    return Rcpp::traits::is_na<RTYPE>(vec[i]);
+  }
+
+  inline radix_key key(int i) const {
+    return radix_traits<RTYPE, ascending>::key(vec[i]);
+  }
+
+private:
+  Vector<RTYPE> vec;
+};
+
+// Sets the test of the rows of the group whose min_rank() is at most n: the rows
+// whose key is at most the n-th smallest key of the group. A max-heap keeps the
+// n smallest keys seen so far, so a group of m rows takes O(m log n) time and
+// O(n) memory.
+template <typename Keys>
+void top_n_group(const Keys& keys, const SlicingIndex& index, int n, std::vector<radix_key>& heap, LogicalVector& test) {
+  if (n <= 0) return;
+
+  heap.clear();
+  int m = index.size();
+  for (int j = 0; j < m; j++) {
+    int i = index[j];
+    if (keys.is_na(i)) continue;
+
+    radix_key k = keys.key(i);
+    if ((int)heap.size() < n) {
+      heap.push_back(k);
+      std::push_heap(heap.begin(), heap.end());
+    } else if (k < heap.front()) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = k;
+      std::push_heap(heap.begin(), heap.end());
+    }
+  }
+  if (heap.empty()) return;
+
+  // with fewer than n values, all of them are kept
+  radix_key threshold = (int)heap.size() < n ? ~(radix_key)0 : heap.front();
+  for (int j = 0; j < m; j++) {
+    int i = index[j];
+    if (!keys.is_na(i) && keys.key(i) <= threshold) test[i] = TRUE;
+  }
+}
+
+template <typename Keys>
+SEXP top_n_filter(const DataFrame& df, const Keys& keys, int n) {
+  LogicalVector test(df.nrows(), FALSE);
+  std::vector<radix_key> heap;
+  heap.reserve(std::max(0, std::min(n, df.nrows())));
+
+  if (is<GroupedDataFrame>(df)) {
+    GroupedDataFrame gdf(df);
+    int ngroups = gdf.ngroups();
+    GroupedDataFrame::group_iterator git = gdf.group_begin();
+    for (int i = 0; i < ngroups; i++, ++git) {
+      top_n_group(keys, *git, n, heap, test);
+    }
+
+    DataFrame res = subset(df, test, df.names(), classes_grouped<GroupedDataFrame>());
+    copy_vars(res, df);
+    filter_index(res, gdf, test);
+    return GroupedDataFrame(res).data();
+  }
+
+  top_n_group(keys, NaturalSlicingIndex(df.nrows()), n, heap, test);
+  return subset(df, test, classes_not_grouped());
+}
+
+template <bool ascending>
+SEXP top_n_filter_column(const DataFrame& df, SEXP x, int n) {
+  switch (TYPEOF(x)) {
+  case LGLSXP:
+    return top_n_filter(df, TopNKeys<LGLSXP, ascending>(x), n);
+  case INTSXP:
+    return top_n_filter(df, TopNKeys<INTSXP, ascending>(x), n);
+  case REALSXP:
+    return top_n_filter(df, TopNKeys<REALSXP, ascending>(x), n);
+  case STRSXP:
+    // strings are ranked in the collation of the locale, as min_rank() does
+    return top_n_filter(df, TopNKeys<INTSXP, ascending>(CharacterVectorOrderer(x).get()), n);
+  default:
+    return R_NilValue;
+  }
+}
+
+// filter(df, min_rank(var) <= n), or min_rank(desc(var)) when descending is true,
+// without ranking all the rows. NULL when var has a type or class whose order
+// min_rank() doesn't take from its values
+// [[Rcpp::export]]
+SEXP filter_top_n_impl(DataFrame df, const SymbolVector& var, int n, bool descending) {
+  if (df.nrows() == 0 || is<RowwiseDataFrame>(df)) return R_NilValue;
+  check_valid_colnames(df);
+  assert_all_white_list(df);
+
+  IntegerVector pos = var.match_in_table(df.names());
+  if (pos[0] == NA_INTEGER) return R_NilValue;
+
+  SEXP x = df[pos[0] - 1];
+  if (OBJECT(x) && !Rf_inherits(x, "factor") && !Rf_inherits(x, "Date") &&
+      !Rf_inherits(x, "POSIXct") && !Rf_inherits(x, "difftime")) {
+    return R_NilValue;
+  }
+
+  return descending ? top_n_filter_column<false>(df, x, n) : top_n_filter_column<true>(df, x, n);
+}
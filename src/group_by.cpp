@@ -11,11 +11,16 @@ using namespace Rcpp;
 using namespace dplyr;
 
 // [[Rcpp::export]]
-DataFrame grouped_df_impl(DataFrame data, SymbolVector symbols, bool drop) {
+DataFrame grouped_df_impl(DataFrame data, SymbolVector symbols, bool drop, bool ordered) {
   assert_all_white_list(data);
   DataFrame copy(shallow_copy(data));
   set_vars(copy, symbols);
   copy.attr("drop") = drop;
+  // the index of unordered groups can't be refined into ordered groups
+  if (!Rf_isNull(copy.attr("ordered_groups"))) {
+    strip_index(copy);
+  }
+  copy.attr("ordered_groups") = ordered ? R_NilValue : Rf_ScalarLogical(FALSE);
   if (!symbols.size())
     stop("no variables to group by");
   return build_index_cpp(copy);
@@ -0,0 +1,244 @@
+#include "pch.h"
+#include <dplyr/main.h>
+
+#include <list>
+#include <clocale>
+
+#include <dplyr/CharacterVectorOrderer.h>
+#include <dplyr/group_cache.h>
+
+#include <tools/utils.h>
+
+using namespace Rcpp;
+using namespace dplyr;
+
+namespace dplyr {
+
+class GroupIndexCache {
+public:
+  // the columns and index of an entry are kept in a preserved list
+  struct Entry {
+    SEXP data;
+    int nrows;
+    bool ordered;
+    std::string collation;
+    size_t size;
+  };
+
+  enum { COLUMNS, ROWS, OFFSETS, LABELS };
+
+  GroupIndexCache() : hits(0), misses(0), total_size(0) {}
+
+  bool lookup(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+              IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+    int n = data.nrows();
+    std::string collation = current_collation();
+
+    // only a handful of entries fit in a sensible budget, a linear scan is enough
+    for (std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+      if (!matches(*it, data, vars, indx, n, ordered, collation)) continue;
+
+      // the most recently used entry comes first
+      entries.splice(entries.begin(), entries, it);
+      hits++;
+
+      SEXP x = entries.front().data;
+      rows = VECTOR_ELT(x, ROWS);
+      offsets = VECTOR_ELT(x, OFFSETS);
+      labels = VECTOR_ELT(x, LABELS);
+      return true;
+    }
+
+    misses++;
+    return false;
+  }
+
+  void insert(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+              const IntegerVector& rows, const IntegerVector& offsets, const DataFrame& labels,
+              size_t budget) {
+    int nvars = vars.size();
+    List columns(nvars);
+    for (int i = 0; i < nvars; i++) {
+      columns[i] = VECTOR_ELT(data, indx[i] - 1);
+    }
+
+    // the entry keeps the grouping columns alive, they count in its size
+    size_t size = entry_size(columns, rows, offsets, labels);
+    if (size > budget) return;
+    shrink(budget - size);
+
+    for (int i = 0; i < nvars; i++) {
+      columns[i] = shared_SEXP(columns[i]);
+    }
+    columns.names() = vars.get_vector();
+
+    List x(4);
+    x[COLUMNS] = columns;
+    x[ROWS] = shared_SEXP(rows);
+    x[OFFSETS] = shared_SEXP(offsets);
+    x[LABELS] = shared_SEXP(labels);
+
+    Entry entry;
+    entry.data = x;
+    entry.nrows = data.nrows();
+    entry.ordered = ordered;
+    entry.collation = current_collation();
+    entry.size = size;
+    R_PreserveObject(entry.data);
+
+    entries.push_front(entry);
+    total_size += size;
+  }
+
+  // evicts the least recently used entries until the cache uses at most budget bytes
+  void shrink(size_t budget) {
+    while (!entries.empty() && total_size > budget) {
+      Entry& entry = entries.back();
+      total_size -= entry.size;
+      R_ReleaseObject(entry.data);
+      entries.pop_back();
+    }
+  }
+
+  void reset_counters() {
+    hits = 0;
+    misses = 0;
+  }
+
+  int hits;
+  int misses;
+  size_t total_size;
+  std::list<Entry> entries;
+
+private:
+
+  bool matches(const Entry& entry, const DataFrame& data, const SymbolVector& vars,
+               const IntegerVector& indx, int n, bool ordered, const std::string& collation) const {
+    if (entry.nrows != n || entry.ordered != ordered || entry.collation != collation) return false;
+
+    SEXP columns = VECTOR_ELT(entry.data, COLUMNS);
+    int nvars = vars.size();
+    if (Rf_length(columns) != nvars) return false;
+
+    SEXP names = Rf_getAttrib(columns, R_NamesSymbol);
+    for (int i = 0; i < nvars; i++) {
+      if (VECTOR_ELT(columns, i) != VECTOR_ELT(data, indx[i] - 1)) return false;
+      if (STRING_ELT(names, i) != vars[i].get_sexp()) return false;
+    }
+    return true;
+  }
+
+  // string labels are sorted in this collation: "C" when by their bytes, else
+  // the collating locale
+  static std::string current_collation() {
+    if (collate_bytes()) return "C";
+    const char* locale = setlocale(LC_COLLATE, NULL);
+    return locale ? locale : "";
+  }
+
+  static size_t vector_size(SEXP x) {
+    size_t n = Rf_xlength(x);
+    switch (TYPEOF(x)) {
+    case REALSXP:
+      return n * sizeof(double);
+    case CPLXSXP:
+      return n * sizeof(Rcomplex);
+    case STRSXP:
+      return n * sizeof(SEXP);
+    default:
+      return n * sizeof(int);
+    }
+  }
+
+  static size_t entry_size(const List& columns, const IntegerVector& rows, const IntegerVector& offsets,
+                           const DataFrame& labels) {
+    size_t size = vector_size(rows) + vector_size(offsets);
+    for (int i = 0; i < columns.size(); i++) {
+      size += vector_size(columns[i]);
+    }
+    for (int i = 0; i < labels.size(); i++) {
+      size += vector_size(labels[i]);
+    }
+    return size;
+  }
+
+};
+
+GroupIndexCache& get_group_cache() {
+  static GroupIndexCache cache;
+  return cache;
+}
+
+// budget of the cache in bytes, 0 when it is disabled
+size_t get_group_cache_budget() {
+  SEXP option = Rf_GetOption1(Rf_install("dplyr.group_cache_size"));
+  if (!Rf_isNumeric(option) || Rf_length(option) != 1) return 0;
+
+  double size = Rf_asReal(option);
+  if (R_IsNA(size) || size < 1) return 0;
+  return static_cast<size_t>(size);
+}
+
+bool group_cache_lookup(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+                        IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+  GroupIndexCache& cache = get_group_cache();
+  size_t budget = get_group_cache_budget();
+  if (budget == 0) {
+    cache.shrink(0);
+    return false;
+  }
+
+  bool found = cache.lookup(data, vars, indx, ordered, rows, offsets, labels);
+  LOG_VERBOSE << "group index cache " << (found ? "hit" : "miss");
+  return found;
+}
+
+void group_cache_insert(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx, bool ordered,
+                        const IntegerVector& rows, const IntegerVector& offsets, const DataFrame& labels) {
+  size_t budget = get_group_cache_budget();
+  if (budget == 0) return;
+
+  get_group_cache().insert(data, vars, indx, ordered, rows, offsets, labels, budget);
+}
+
+}
+
+//' Group index cache
+//'
+//' When the `dplyr.group_cache_size` option is set to a number of bytes,
+//' the indices built by [group_by()] are cached and reused as long as the
+//' grouping columns are unchanged. `group_cache_info()` gives the number of
+//' cache hits and misses, the number of cached indices and their size in
+//' bytes. `group_cache_clear()` empties the cache and resets the counters.
+//'
+//' The size of a cached index includes the grouping columns it was built on:
+//' the cache keeps them alive until the index is evicted.
+//'
+//' @export
+//' @examples
+//' options(dplyr.group_cache_size = 1e6)
+//' by_cyl <- group_by(mtcars, cyl)
+//' by_cyl <- group_by(mtcars, cyl)
+//' group_cache_info()
+//' group_cache_clear()
+//' options(dplyr.group_cache_size = 0)
+// [[Rcpp::export]]
+List group_cache_info() {
+  GroupIndexCache& cache = get_group_cache();
+  return List::create(
+           _["hits"] = cache.hits,
+           _["misses"] = cache.misses,
+           _["entries"] = (int)cache.entries.size(),
+           _["size"] = (double)cache.total_size,
+           _["budget"] = (double)get_group_cache_budget()
+         );
+}
+
+//' @rdname group_cache_info
+//' @export
+// [[Rcpp::export]]
+void group_cache_clear() {
+  GroupIndexCache& cache = get_group_cache();
+  cache.shrink(0);
+  cache.reset_counters();
+}
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include <dplyr/main.h>
 
+#include <boost/scoped_ptr.hpp>
+
 #include <tools/match.h>
 
 #include <dplyr/white_list.h>
@@ -8,10 +10,12 @@
 #include <dplyr/GroupedDataFrame.h>
 
 #include <dplyr/Order.h>
+#include <dplyr/SortKeys.h>
 
 #include <dplyr/Result/Count.h>
 
 #include <dplyr/train.h>
+#include <dplyr/group_cache.h>
 
 #include <dplyr/bad.h>
 
@@ -23,12 +27,11 @@ IntegerVector grouped_indices_grouped_df_impl(GroupedDataFrame gdf) {
   int n = gdf.nrows();
   IntegerVector res = no_init(n);
   int ngroups = gdf.ngroups();
-  GroupedDataFrameIndexIterator it = gdf.group_begin();
-  for (int i = 0; i < ngroups; i++, ++it) {
-    const SlicingIndex& index = *it;
-    int n_index = index.size();
-    for (int j = 0; j < n_index; j++) {
-      res[ index[j] ] = i + 1;
+  const int* rows = Rcpp::internal::r_vector_start<INTSXP>(gdf.rows());
+  const int* offsets = Rcpp::internal::r_vector_start<INTSXP>(gdf.offsets());
+  for (int i = 0; i < ngroups; i++) {
+    for (int j = offsets[i]; j < offsets[i + 1]; j++) {
+      res[rows[j]] = i + 1;
     }
   }
   return res;
@@ -39,8 +42,350 @@ IntegerVector group_size_grouped_cpp(GroupedDataFrame gdf) {
   return Count().process(gdf);
 }
 
-DataFrame build_index_cpp(DataFrame data) {
-  SymbolVector vars(get_vars(data));
+// The group index is stored flat in the "group_rows" and "group_offsets" attributes,
+// this materializes it as a list of (0-based) row indices, one element per group,
+// as stored in the "indices" attribute.
+List index_list(const IntegerVector& rows, const IntegerVector& offsets) {
+  int ngroups = offsets.size() - 1;
+  List res(ngroups);
+  for (int i = 0; i < ngroups; i++) {
+    res[i] = IntegerVector(rows.begin() + offsets[i], rows.begin() + offsets[i + 1]);
+  }
+  return res;
+}
+
+// [[Rcpp::export]]
+List group_index_list(GroupedDataFrame gdf) {
+  return index_list(gdf.rows(), gdf.offsets());
+}
+
+namespace dplyr {
+
+// Integer, factor and logical grouping variables are turned into dense codes
+// in [0, ncodes). Codes follow the order of the values, with NA last, consistently
+// with OrderVisitors, so that sorting by codes also sorts the labels.
+class IntegerGroupingKey {
+public:
+  IntegerGroupingKey(SEXP x) :
+    data(INTEGER(x)), min_value(0), ncodes(1)
+  {}
+
+  // Computes the range of the data, returns false if it is too wide
+  // to be worth a counting sort.
+  bool train(int n) {
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = 0; i < n; i++) {
+      int value = data[i];
+      if (value == NA_INTEGER) continue;
+      if (value < lo) lo = value;
+      if (value > hi) hi = value;
+    }
+
+    // only NA
+    if (lo > hi) return true;
+
+    // one slot per value in the range, plus one for NA
+    double range = (double)hi - (double)lo + 2.0;
+    if (range > std::max(n, DPLYR_MIN_COUNTING_SORT_RANGE)) return false;
+
+    min_value = lo;
+    ncodes = (int)range;
+    return true;
+  }
+
+  inline int code(int i) const {
+    int value = data[i];
+    return value == NA_INTEGER ? ncodes - 1 : value - min_value;
+  }
+
+  inline int size() const {
+    return ncodes;
+  }
+
+private:
+  int* data;
+  int min_value;
+  int ncodes;
+};
+
+inline bool is_counting_sort_candidate(SEXP x, int n) {
+  return (TYPEOF(x) == INTSXP || TYPEOF(x) == LGLSXP) && Rf_length(x) == n && !Rf_isMatrix(x);
+}
+
+// Builds the index with a least significant digit radix sort where each grouping
+// variable is a digit. Each pass is a stable counting sort, so rows stay in
+// ascending order within each group and groups come out in the order of the labels.
+bool build_index_counting_sort(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx,
+                               IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+  const int nvars = vars.size();
+  const int n = data.nrows();
+
+  std::vector<IntegerGroupingKey> keys;
+  keys.reserve(nvars);
+  for (int i = 0; i < nvars; i++) {
+    SEXP v = data[indx[i] - 1];
+    if (!is_counting_sort_candidate(v, n)) return false;
+
+    IntegerGroupingKey key(v);
+    if (!key.train(n)) return false;
+    keys.push_back(key);
+  }
+
+  LOG_VERBOSE << "building index with counting sort on " << nvars << " variables";
+
+  std::vector<int> order(n), buffer(n);
+  for (int i = 0; i < n; i++) order[i] = i;
+
+  std::vector<int> counts;
+  for (int k = nvars - 1; k >= 0; k--) {
+    const IntegerGroupingKey& key = keys[k];
+
+    counts.assign(key.size() + 1, 0);
+    for (int i = 0; i < n; i++) {
+      counts[key.code(order[i]) + 1]++;
+    }
+    for (int j = 1; j < key.size(); j++) {
+      counts[j] += counts[j - 1];
+    }
+    for (int i = 0; i < n; i++) {
+      int row = order[i];
+      buffer[counts[key.code(row)]++] = row;
+    }
+    order.swap(buffer);
+  }
+
+  // groups are runs of equal codes in the sorted rows
+  std::vector<int> starts;
+  if (n > 0) starts.push_back(0);
+  for (int i = 1; i < n; i++) {
+    int current = order[i], previous = order[i - 1];
+    for (int k = 0; k < nvars; k++) {
+      if (keys[k].code(current) != keys[k].code(previous)) {
+        starts.push_back(i);
+        break;
+      }
+    }
+  }
+
+  int ngroups = starts.size();
+  rows = IntegerVector(order.begin(), order.end());
+  offsets = no_init(ngroups + 1);
+
+  std::vector<int> first_rows(ngroups);
+  for (int i = 0; i < ngroups; i++) {
+    offsets[i] = starts[i];
+    first_rows[i] = order[starts[i]];
+  }
+  offsets[ngroups] = n;
+
+  labels = DataFrameSubsetVisitors(data, vars).subset(first_rows, "data.frame");
+  return true;
+}
+
+// When data is already grouped by the first variables of vars, e.g. with
+// group_by(add = TRUE), each existing group is sorted by the added variables
+// only and split into runs of equal values. The existing grouping variables
+// are neither hashed nor compared.
+bool build_index_refine(const DataFrame& data, const SymbolVector& vars, const IntegerVector& indx,
+                        IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+  if (!Rf_inherits(data, "grouped_df")) return false;
+
+  SEXP old_rows = data.attr("group_rows");
+  SEXP old_offsets = data.attr("group_offsets");
+  SEXP old_labels = data.attr("labels");
+  if (Rf_isNull(old_rows) || Rf_isNull(old_offsets) || Rf_isNull(old_labels)) return false;
+
+  const int n = data.nrows();
+  const int nvars = vars.size();
+  const int nold = Rf_length(old_labels);
+  const int old_ngroups = Rf_length(old_offsets) - 1;
+  if (nold == 0 || nold >= nvars || Rf_length(old_rows) != n || old_ngroups < 0 ||
+      DataFrame(old_labels).nrows() != old_ngroups) return false;
+
+  SymbolVector old_vars(Rf_getAttrib(old_labels, R_NamesSymbol));
+  for (int k = 0; k < nold; k++) {
+    if (!(old_vars[k] == vars[k])) return false;
+  }
+
+  const int* p_old_offsets = INTEGER(old_offsets);
+  if (p_old_offsets[old_ngroups] != n) return false;
+
+  // base R modifications of the columns, e.g. `gdf$a <- rev(gdf$a)`, keep the
+  // attributes of the index: it is only trusted if it was built on these columns
+  SEXP old_columns = data.attr("group_columns");
+  if (TYPEOF(old_columns) != VECSXP || Rf_length(old_columns) != nold) return false;
+  for (int k = 0; k < nold; k++) {
+    if (VECTOR_ELT(old_columns, k) != VECTOR_ELT(data, indx[k] - 1)) return false;
+  }
+
+  LOG_VERBOSE << "refining " << old_ngroups << " groups by " << nvars - nold << " variables";
+
+  const int nnew = nvars - nold;
+  List new_columns(nnew);
+  for (int k = 0; k < nnew; k++) {
+    new_columns[k] = data[indx[nold + k] - 1];
+  }
+  OrderVisitors order(new_columns, LogicalVector(nnew, TRUE), nnew);
+  OrderVisitors_Compare compare(order);
+
+  // with normalized keys, rows compare with a memcmp() instead of walking the visitors
+  boost::scoped_ptr<SortKeys> keys;
+  if (SortKeys::sortable(order.visitors)) keys.reset(new SortKeys(order.visitors, n));
+  IdentityIndex rows_index;
+
+  rows = no_init(n);
+  int* p_rows = Rcpp::internal::r_vector_start<INTSXP>(rows);
+  std::copy(INTEGER(old_rows), INTEGER(old_rows) + n, p_rows);
+
+  std::vector<int> starts;
+  starts.reserve(old_ngroups);
+  for (int g = 0; g < old_ngroups; g++) {
+    int begin = p_old_offsets[g], end = p_old_offsets[g + 1];
+
+    // ties are broken by row id, so rows stay in ascending order within each group
+    if (keys) {
+      std::sort(p_rows + begin, p_rows + end, SortKeys_Compare<IdentityIndex>(*keys, rows_index));
+    } else {
+      std::sort(p_rows + begin, p_rows + end, compare);
+    }
+
+    for (int j = begin; j < end; j++) {
+      if (j == begin) {
+        starts.push_back(j);
+        continue;
+      }
+      int current = p_rows[j], previous = p_rows[j - 1];
+      if (keys) {
+        if (!keys->equal(previous, current)) starts.push_back(j);
+        continue;
+      }
+      for (int k = 0; k < nnew; k++) {
+        if (!order.visitors[k]->equal(previous, current)) {
+          starts.push_back(j);
+          break;
+        }
+      }
+    }
+  }
+
+  int ngroups = starts.size();
+  offsets = no_init(ngroups + 1);
+  std::vector<int> first_rows(ngroups);
+  for (int i = 0; i < ngroups; i++) {
+    offsets[i] = starts[i];
+    first_rows[i] = p_rows[starts[i]];
+  }
+  offsets[ngroups] = n;
+
+  labels = DataFrameSubsetVisitors(data, vars).subset(first_rows, "data.frame");
+  return true;
+}
+
+// When ordered is false the labels are not sorted, and the groups
+// come out in the arbitrary order of the hash map. Large data whose visitors
+// are thread_safe() are hashed on several threads.
+void build_index_hash(const DataFrame& data, const SymbolVector& vars, bool ordered,
+                      IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+  DataFrameVisitors visitors(data, vars);
+
+  int n = data.nrows();
+  int nthreads = visitors.thread_safe() ? get_nthreads(n) : 1;
+
+  // the rows of each group, in ascending order, are begins[g] to ends[g] - 1
+  std::vector<const int*> begins, ends;
+
+  ChunkIndexMap map(visitors);
+  std::vector<JoinHashTableData> tables;
+  if (nthreads > 1) {
+    LOG_VERBOSE << "building index with " << nthreads << " threads";
+    train_hash_tables_parallel(visitors, n, nthreads, tables);
+    for (size_t p = 0; p < tables.size(); p++) {
+      const JoinHashTableData& table = tables[p];
+      for (int k = 0; k < table.nkeys; k++) {
+        begins.push_back(&table.rows[0] + table.offsets[k]);
+        ends.push_back(&table.rows[0] + table.offsets[k + 1]);
+      }
+    }
+  } else {
+    train_push_back(map, n);
+    for (ChunkIndexMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+      begins.push_back(&it->second[0]);
+      ends.push_back(&it->second[0] + it->second.size());
+    }
+  }
+
+  int ngroups = begins.size();
+  std::vector<int> first_rows(ngroups);
+  for (int i = 0; i < ngroups; i++) {
+    first_rows[i] = *begins[i];
+  }
+
+  labels = DataFrameSubsetVisitors(data, vars).subset(first_rows, "data.frame");
+  IntegerVector labels_order;
+  if (ordered) {
+    labels_order = OrderVisitors(labels).apply();
+    labels = DataFrameSubsetVisitors(labels).subset(labels_order, "data.frame");
+  } else {
+    labels_order = no_init(ngroups);
+    for (int i = 0; i < ngroups; i++) labels_order[i] = i;
+  }
+
+  rows = no_init(n);
+  offsets = no_init(ngroups + 1);
+
+  int* p_rows = Rcpp::internal::r_vector_start<INTSXP>(rows);
+  int k = 0;
+  for (int i = 0; i < ngroups; i++) {
+    int idx = labels_order[i];
+    offsets[i] = k;
+    std::copy(begins[idx], ends[idx], p_rows + k);
+    k += ends[idx] - begins[idx];
+  }
+  offsets[ngroups] = k;
+}
+
+// Puts the groups in the order of their first appearance in the data
+void order_groups_by_first_row(IntegerVector& rows, IntegerVector& offsets, DataFrame& labels) {
+  const int n = rows.size();
+  const int ngroups = offsets.size() - 1;
+
+  // rows are in ascending order within each group, so the first row of a group is its smallest
+  std::vector<int> group_starting_at(n, -1);
+  for (int g = 0; g < ngroups; g++) {
+    group_starting_at[rows[offsets[g]]] = g;
+  }
+  std::vector<int> order;
+  order.reserve(ngroups);
+  for (int i = 0; i < n; i++) {
+    if (group_starting_at[i] >= 0) order.push_back(group_starting_at[i]);
+  }
+
+  IntegerVector new_rows = no_init(n);
+  IntegerVector new_offsets = no_init(ngroups + 1);
+  int k = 0;
+  for (int i = 0; i < ngroups; i++) {
+    int g = order[i];
+    new_offsets[i] = k;
+    std::copy(rows.begin() + offsets[g], rows.begin() + offsets[g + 1], new_rows.begin() + k);
+    k += offsets[g + 1] - offsets[g];
+  }
+  new_offsets[ngroups] = k;
+
+  rows = new_rows;
+  offsets = new_offsets;
+  labels = DataFrameSubsetVisitors(labels).subset(order, "data.frame");
+}
+
+}
+
+// false when the data was grouped with `ordered = FALSE`
+bool has_ordered_groups(const DataFrame& data) {
+  SEXP ordered = Rf_getAttrib(data, Rf_install("ordered_groups"));
+  return Rf_isNull(ordered) || Rf_asLogical(ordered) != FALSE;
+}
+
+// positions (1-based) of the grouping variables in data
+static IntegerVector check_grouping_vars(const DataFrame& data, const SymbolVector& vars) {
   const int nvars = vars.size();
 
   CharacterVector names = data.names();
@@ -59,46 +404,111 @@ DataFrame build_index_cpp(DataFrame data) {
               _["type"] = get_single_class(v));
     }
   }
+  return indx;
+}
+
+// Dense 1-based group ids of the rows of data, from a single hashing pass
+// over the grouping variables, without building the index of each group.
+// Ids follow the first appearance of the groups or, when sorted is true,
+// the order of the sorted labels. The "n" attribute is the number of groups.
+// [[Rcpp::export]]
+IntegerVector group_ids_impl(DataFrame data, SymbolVector vars, bool sorted) {
+  check_grouping_vars(data, vars);
+
+  const int n = data.nrows();
+  IntegerVector ids = no_init(n);
 
   DataFrameVisitors visitors(data, vars);
-  ChunkIndexMap map(visitors);
+  VisitorSetIndexMap<DataFrameVisitors, int> map(visitors);
+  std::vector<int> first_rows;
+  for (int i = 0; i < n; i++) {
+    std::pair<VisitorSetIndexMap<DataFrameVisitors, int>::iterator, bool> res =
+      map.insert(std::make_pair(i, (int)first_rows.size()));
+    if (res.second) first_rows.push_back(i);
+    ids[i] = res.first->second + 1;
+  }
+  int ngroups = first_rows.size();
 
-  train_push_back(map, data.nrows());
+  if (sorted && ngroups > 1) {
+    DataFrame labels = DataFrameSubsetVisitors(data, vars).subset(first_rows, "data.frame");
+    IntegerVector order = OrderVisitors(labels).apply();
 
-  DataFrame labels = DataFrameSubsetVisitors(data, vars).subset(map, "data.frame");
-  int ngroups = labels.nrows();
-  IntegerVector labels_order = OrderVisitors(labels).apply();
+    std::vector<int> rank(ngroups);
+    for (int k = 0; k < ngroups; k++) {
+      rank[order[k]] = k + 1;
+    }
+    for (int i = 0; i < n; i++) {
+      ids[i] = rank[ids[i] - 1];
+    }
+  }
 
-  labels = DataFrameSubsetVisitors(labels).subset(labels_order, "data.frame");
+  ids.attr("n") = ngroups;
+  return ids;
+}
 
-  List indices(ngroups);
-  IntegerVector group_sizes = no_init(ngroups);
-  int biggest_group = 0;
+DataFrame build_index_cpp(DataFrame data) {
+  SymbolVector vars(get_vars(data));
+  IntegerVector indx = check_grouping_vars(data, vars);
 
-  ChunkIndexMap::const_iterator it = map.begin();
-  std::vector<const std::vector<int>* > chunks(ngroups);
-  for (int i = 0; i < ngroups; i++, ++it) {
-    chunks[i] = &it->second;
-  }
+  IntegerVector rows, offsets;
+  DataFrame labels;
 
-  for (int i = 0; i < ngroups; i++) {
-    int idx = labels_order[i];
-    const std::vector<int>& chunk = *chunks[idx];
-    indices[i] = chunk;
-    group_sizes[i] = chunk.size();
-    biggest_group = std::max(biggest_group, (int)chunk.size());
+  bool ordered = has_ordered_groups(data);
+
+  if (!group_cache_lookup(data, vars, indx, ordered, rows, offsets, labels)) {
+    // existing groups are refined by the added variables,
+    // integer, factor and logical keys with a small range don't need hashing.
+    // Unordered groups avoid sorting labels, which calls back to R for strings
+    if (!(ordered && build_index_refine(data, vars, indx, rows, offsets, labels)) &&
+        !build_index_counting_sort(data, vars, indx, rows, offsets, labels)) {
+      build_index_hash(data, vars, ordered, rows, offsets, labels);
+    }
+    if (!ordered) {
+      order_groups_by_first_row(rows, offsets, labels);
+    }
+    group_cache_insert(data, vars, indx, ordered, rows, offsets, labels);
   }
 
-  data.attr("indices") = indices;
-  data.attr("group_sizes") = group_sizes;
-  data.attr("biggest_group_size") = biggest_group;
-  data.attr("labels") = labels;
+  set_index(data, rows, offsets, labels);
   set_class(data, CharacterVector::create("grouped_df", "tbl_df", "tbl", "data.frame"));
   return data;
 }
 
+void set_index(DataFrame x, const IntegerVector& rows, const IntegerVector& offsets, const DataFrame& labels) {
+  int ngroups = offsets.size() - 1;
+  IntegerVector group_sizes = no_init(ngroups);
+  int biggest_group = 0;
+  for (int i = 0; i < ngroups; i++) {
+    int size = offsets[i + 1] - offsets[i];
+    group_sizes[i] = size;
+    biggest_group = std::max(biggest_group, size);
+  }
+
+  // the grouping columns the index was built on, kept alive so that an index
+  // whose columns were replaced is not mistaken for the index of the new ones
+  SymbolVector vars(labels.names());
+  IntegerVector indx = vars.match_in_table(x.names());
+  List columns(vars.size());
+  for (int i = 0; i < vars.size(); i++) {
+    if (indx[i] != NA_INTEGER) columns[i] = shared_SEXP(x[indx[i] - 1]);
+  }
+
+  // C++ code iterates over the flat index, "indices" is kept for the R code
+  // and the packages that read it
+  x.attr("indices") = index_list(rows, offsets);
+  x.attr("group_columns") = columns;
+  x.attr("group_rows") = rows;
+  x.attr("group_offsets") = offsets;
+  x.attr("group_sizes") = group_sizes;
+  x.attr("biggest_group_size") = biggest_group;
+  x.attr("labels") = labels;
+}
+
 void strip_index(DataFrame x) {
   x.attr("indices") = R_NilValue;
+  x.attr("group_columns") = R_NilValue;
+  x.attr("group_rows") = R_NilValue;
+  x.attr("group_offsets") = R_NilValue;
   x.attr("group_sizes") = R_NilValue;
   x.attr("biggest_group_size") = R_NilValue;
   x.attr("labels") = R_NilValue;
@@ -109,7 +519,7 @@ SEXP strip_group_attributes(SEXP df) {
   SET_TAG(attribs, Rf_install("class"));
 
   SEXP p = ATTRIB(df);
-  std::vector<SEXP> black_list(8);
+  std::vector<SEXP> black_list(12);
   black_list[0] = Rf_install("indices");
   black_list[1] = Rf_install("vars");
   black_list[2] = Rf_install("index");
@@ -118,6 +528,10 @@ SEXP strip_group_attributes(SEXP df) {
   black_list[5] = Rf_install("group_sizes");
   black_list[6] = Rf_install("biggest_group_size");
   black_list[7] = Rf_install("class");
+  black_list[8] = Rf_install("group_rows");
+  black_list[9] = Rf_install("group_offsets");
+  black_list[10] = Rf_install("ordered_groups");
+  black_list[11] = Rf_install("group_columns");
 
   SEXP q = attribs;
   while (! Rf_isNull(p)) {
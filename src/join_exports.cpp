@@ -6,13 +6,18 @@
 
 #include <tools/Quosure.h>
 
-#include <dplyr/visitor_set/VisitorSetIndexMap.h>
 
 #include <dplyr/GroupedDataFrame.h>
 
 #include <dplyr/DataFrameJoinVisitors.h>
+#include <dplyr/JoinHashTable.h>
+#include <dplyr/JoinHashSet.h>
+#include <dplyr/KeyIndex.h>
 
-#include <dplyr/train.h>
+#include <tools/threads.h>
+
+#include <climits>
+#include <set>
 
 #include <dplyr/bad.h>
 
@@ -134,17 +139,9 @@ DataFrame subset_join(DataFrame x, DataFrame y,
   return (SEXP)out;
 }
 
-template <typename TargetContainer, typename SourceContainer>
-void push_back(TargetContainer& x, const SourceContainer& y) {
-  x.insert(x.end(), y.begin(), y.end());
-}
-template <typename TargetContainer, typename SourceContainer>
-void push_back_right(TargetContainer& x, const SourceContainer& y) {
-  // x.insert( x.end(), y.begin(), y.end() );
-  int n = y.size();
-  for (int i = 0; i < n; i++) {
-    x.push_back(-y[i] - 1);
-  }
+template <typename Container>
+void push_back(Container& x, const int* begin, const int* end) {
+  x.insert(x.end(), begin, end);
 }
 
 template <typename Container>
@@ -157,36 +154,510 @@ void check_by(const CharacterVector& by) {
   if (by.size() == 0) bad_arg("by", "must specify variables to join by");
 }
 
-// [[Rcpp::export]]
-DataFrame semi_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match) {
-  check_by(by_x);
+// Builds the hash table on the build side and probes it with every row of the
+// probe side, then lays out the matching probe rows of each build row, in
+// ascending order, as matches[offsets[i]] to matches[offsets[i + 1] - 1].
+// Used when the probe side is the larger table: the hash table follows the size
+// of the smaller table while the output can still follow the order of the build side.
+// build_right tells whether the build side is the right table of the visitors,
+// probe_matched flags the probe rows that have at least one match.
+void match_build_rows(DataFrameJoinVisitors& visitors, int n_build, bool build_right, int n_probe,
+                      std::vector<int>& offsets, std::vector<int>& matches,
+                      std::vector<bool>& probe_matched) {
+  JoinHashTable<DataFrameJoinVisitors> table(visitors);
+  table.build(n_build, build_right);
+
+  std::vector<int> probe_keys(n_probe);
+  std::vector<int> counts(n_build + 1, 0);
+  probe_matched.assign(n_probe, false);
+  for (int j = 0; j < n_probe; j++) {
+    int k = table.find(build_right ? j : -j - 1);
+    probe_keys[j] = k;
+    if (k >= 0) {
+      probe_matched[j] = true;
+      for (const int* it = table.begin(k); it != table.end(k); ++it) {
+        counts[*it + 1]++;
+      }
+    }
+  }
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
-  DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), true, na_match);
-  Map map(visitors);
+  offsets.resize(n_build + 1);
+  offsets[0] = 0;
+  for (int i = 0; i < n_build; i++) {
+    offsets[i + 1] = offsets[i] + counts[i + 1];
+  }
 
-  // train the map in terms of x
-  train_push_back(map, x.nrows());
+  // probe rows are visited in ascending order, so they stay sorted for each build row
+  std::copy(offsets.begin(), offsets.end() - 1, counts.begin());
+  matches.resize(offsets[n_build]);
+  for (int j = 0; j < n_probe; j++) {
+    int k = probe_keys[j];
+    if (k < 0) continue;
+    for (const int* it = table.begin(k); it != table.end(k); ++it) {
+      matches[counts[*it]++] = j;
+    }
+  }
+}
 
-  int n_y = y.nrows();
-  // this will collect indices from rows in x that match rows in y
-  std::vector<int> indices;
-  indices.reserve(x.nrow());
-  for (int i = 0; i < n_y; i++) {
-    // find a row in x that matches row i from y
-    Map::iterator it = map.find(-i - 1);
+// Hashes of the n rows of the left table, or of the right table if right is true
+void hash_rows(DataFrameJoinVisitors& visitors, int n, bool right, int nthreads, std::vector<size_t>& hashes) {
+  hashes.resize(n);
 
-    if (it != map.end()) {
-      // collect the indices and remove them from the
-      // map so that they are only found once.
-      push_back(indices, it->second);
+  #pragma omp parallel for num_threads(nthreads) schedule(static)
+  for (int i = 0; i < n; i++) {
+    hashes[i] = visitors.hash(right ? -i - 1 : i);
+  }
+}
 
-      map.erase(it);
+// Radix partitioned hash join for large tables, whose join visitors are
+// thread_safe(). Both tables are partitioned by the
+// hash of their keys, so that matching rows are in the same partition, and the
+// partitions are joined by the worker threads with a table built on the smaller side.
+// Matches are then laid out in the order of the rows of x, with the matching rows of
+// y in ascending order, as inner_join_impl() and left_join_impl() do. When
+// keep_unmatched is true, rows of x without a match get -1 as their row of y.
+// x_left tells whether x is the left table of the visitors.
+void partitioned_join(DataFrameJoinVisitors& visitors, bool x_left, int n_x, int n_y,
+                      bool keep_unmatched, int nthreads,
+                      std::vector<int>& indices_x, std::vector<int>& indices_y) {
+  bool build_x = n_x < n_y;
+  int n_build = build_x ? n_x : n_y;
+
+  int npartitions = hash_partitions(n_build, nthreads);
+  LOG_VERBOSE << "joining " << npartitions << " partitions with " << nthreads << " threads";
+
+  std::vector<int> offsets_x, rows_x, offsets_y, rows_y;
+  std::vector<size_t> hashes_x, hashes_y;
+  {
+    std::vector<size_t> hashes;
+    hash_rows(visitors, n_x, !x_left, nthreads, hashes);
+    partition_rows(hashes, npartitions, offsets_x, rows_x, hashes_x);
+    hash_rows(visitors, n_y, x_left, nthreads, hashes);
+    partition_rows(hashes, npartitions, offsets_y, rows_y, hashes_y);
+  }
 
+  const std::vector<int>& build_offsets = build_x ? offsets_x : offsets_y;
+  const std::vector<int>& build_rows = build_x ? rows_x : rows_y;
+  const std::vector<size_t>& build_hashes = build_x ? hashes_x : hashes_y;
+  const std::vector<int>& probe_offsets = build_x ? offsets_y : offsets_x;
+  const std::vector<int>& probe_rows = build_x ? rows_y : rows_x;
+  const std::vector<size_t>& probe_hashes = build_x ? hashes_y : hashes_x;
+  bool build_right = build_x != x_left;
+
+  // matches found in each partition, and number of matches of each row of x,
+  // which belongs to a single partition
+  std::vector< std::vector<int> > matches_x(npartitions), matches_y(npartitions);
+  std::vector<int> counts(n_x, 0);
+
+  // the worker threads can't throw: running out of memory is reported after the loop
+  bool out_of_memory = false;
+
+  #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+  for (int p = 0; p < npartitions; p++) {
+    int begin = build_offsets[p];
+    int n = build_offsets[p + 1] - begin;
+    if (n == 0) continue;
+
+    try {
+      JoinHashTable<DataFrameJoinVisitors> table(visitors);
+      table.build(n, build_right, &build_rows[begin], &build_hashes[begin]);
+
+      std::vector<int>& part_x = matches_x[p];
+      std::vector<int>& part_y = matches_y[p];
+      for (int q = probe_offsets[p]; q < probe_offsets[p + 1]; q++) {
+        int row = probe_rows[q];
+        int k = table.find(build_right ? row : -row - 1, probe_hashes[q]);
+        if (k < 0) continue;
+
+        for (const int* it = table.begin(k); it != table.end(k); ++it) {
+          int row_x = build_x ? *it : row;
+          part_x.push_back(row_x);
+          part_y.push_back(build_x ? row : *it);
+          counts[row_x]++;
+        }
+      }
+    } catch (const std::bad_alloc&) {
+      #pragma omp critical
+      out_of_memory = true;
+    }
+  }
+  if (out_of_memory) throw std::bad_alloc();
+
+  std::vector<int> offsets(n_x + 1);
+  offsets[0] = 0;
+  for (int i = 0; i < n_x; i++) {
+    int count = (keep_unmatched && counts[i] == 0) ? 1 : counts[i];
+    offsets[i + 1] = offsets[i] + count;
+    // counts become the insertion positions
+    counts[i] = offsets[i];
+  }
+  indices_x.resize(offsets[n_x]);
+  indices_y.resize(offsets[n_x]);
+
+  // each partition writes the matches of its own rows of x
+  #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+  for (int p = 0; p < npartitions; p++) {
+    const std::vector<int>& part_x = matches_x[p];
+    const std::vector<int>& part_y = matches_y[p];
+    int n = part_x.size();
+    for (int m = 0; m < n; m++) {
+      int pos = counts[part_x[m]]++;
+      indices_x[pos] = part_x[m];
+      indices_y[pos] = part_y[m];
     }
   }
 
-  std::sort(indices.begin(), indices.end());
+  if (keep_unmatched) {
+    for (int i = 0; i < n_x; i++) {
+      if (counts[i] == offsets[i]) {
+        indices_x[offsets[i]] = i;
+        indices_y[offsets[i]] = -1; // mark NA
+      }
+    }
+  }
+}
+
+// Whether the n rows of the left table, or of the right table if right is true,
+// are sorted on the keys. Stops at the first row out of order.
+bool sorted_on_keys(const DataFrameJoinVisitors& visitors, int n, bool right) {
+  for (int i = 1; i < n; i++) {
+    if (right ? visitors.compare(-i, -i - 1) > 0 : visitors.compare(i - 1, i) > 0) return false;
+  }
+  return true;
+}
+
+class JoinRowLess {
+public:
+  JoinRowLess(const DataFrameJoinVisitors& visitors_, bool right_) : visitors(visitors_), right(right_) {}
+
+  inline bool operator()(int i, int j) const {
+    return visitors.compare(right ? -i - 1 : i, right ? -j - 1 : j) < 0;
+  }
+
+private:
+  const DataFrameJoinVisitors& visitors;
+  bool right;
+};
+
+// Decides whether to join with a merge: always for method "merge", and for method
+// "auto" when both tables are already sorted on the keys. Tables that are not sorted
+// get the order of their rows in order_x and order_y, which stay empty otherwise.
+// With "auto", the smaller table is checked first so that an unsorted one does
+// not cost a scan of the bigger one.
+bool prepare_merge_join(const DataFrameJoinVisitors& visitors, const std::string& method,
+                        int n_x, bool x_right, int n_y,
+                        std::vector<int>& order_x, std::vector<int>& order_y) {
+  if (method == "hash") return false;
+  bool merge = method == "merge";
+
+  bool sorted_x, sorted_y;
+  if (n_y <= n_x) {
+    sorted_y = sorted_on_keys(visitors, n_y, !x_right);
+    if (!sorted_y && !merge) return false;
+    sorted_x = sorted_on_keys(visitors, n_x, x_right);
+    if (!sorted_x && !merge) return false;
+  } else {
+    sorted_x = sorted_on_keys(visitors, n_x, x_right);
+    if (!sorted_x && !merge) return false;
+    sorted_y = sorted_on_keys(visitors, n_y, !x_right);
+    if (!sorted_y && !merge) return false;
+  }
+
+  LOG_VERBOSE << "merge join, sorted x: " << sorted_x << ", sorted y: " << sorted_y;
+  if (!sorted_x) {
+    order_x.resize(n_x);
+    for (int i = 0; i < n_x; i++) order_x[i] = i;
+    std::stable_sort(order_x.begin(), order_x.end(), JoinRowLess(visitors, x_right));
+  }
+  if (!sorted_y) {
+    order_y.resize(n_y);
+    for (int i = 0; i < n_y; i++) order_y[i] = i;
+    std::stable_sort(order_y.begin(), order_y.end(), JoinRowLess(visitors, !x_right));
+  }
+  return true;
+}
+
+// One table of a merge join: its k-th row in the order of the keys is order[k],
+// or simply k when the table is already sorted.
+class MergeSide {
+public:
+  MergeSide(int n_, bool right_, const std::vector<int>& order_) :
+    n(n_), right(right_), order(order_.empty() ? NULL : &order_[0])
+  {}
+
+  inline int row(int k) const {
+    return order ? order[k] : k;
+  }
+
+  // the k-th row, as an index of the visitor set
+  inline int idx(int k) const {
+    return right ? -row(k) - 1 : row(k);
+  }
+
+  int n;
+  bool right;
+
+private:
+  const int* order;
+};
+
+// the end of the run of rows with the same keys as the k-th row
+inline int run_end(const DataFrameJoinVisitors& visitors, const MergeSide& side, int k) {
+  int idx = side.idx(k);
+  int end = k + 1;
+  while (end < side.n && visitors.compare(idx, side.idx(end)) == 0) end++;
+  return end;
+}
+
+// Merges x and y in the order of their keys and hands the runs of rows to out:
+// matching runs to out.matched(), the others to out.unmatched_x() and
+// out.unmatched_y(). Runs of equal keys that do not match, i.e. NA with
+// na_match false, are unmatched on both sides. Uses no memory.
+template <typename Output>
+void merge_join(const DataFrameJoinVisitors& visitors, const MergeSide& x, const MergeSide& y, Output& out) {
+  int i = 0, j = 0;
+  while (i < x.n && j < y.n) {
+    int res = visitors.compare(x.idx(i), y.idx(j));
+    if (res < 0) {
+      out.unmatched_x(x, i, i + 1);
+      i++;
+    } else if (res > 0) {
+      out.unmatched_y(y, j, j + 1);
+      j++;
+    } else {
+      int i_end = run_end(visitors, x, i);
+      int j_end = run_end(visitors, y, j);
+      if (visitors.equal(x.idx(i), y.idx(j))) {
+        out.matched(x, i, i_end, y, j, j_end);
+      } else {
+        out.unmatched_x(x, i, i_end);
+        out.unmatched_y(y, j, j_end);
+      }
+      i = i_end;
+      j = j_end;
+    }
+  }
+  if (i < x.n) out.unmatched_x(x, i, x.n);
+  if (j < y.n) out.unmatched_y(y, j, y.n);
+}
+
+// pairs of matching rows, x-major, and with keep_x the rows of x without a match, with -1 as row of y
+class MergeJoinPairs {
+public:
+  MergeJoinPairs(std::vector<int>& indices_x_, std::vector<int>& indices_y_, bool keep_x_) :
+    indices_x(indices_x_), indices_y(indices_y_), keep_x(keep_x_)
+  {}
+
+  inline void matched(const MergeSide& x, int i, int i_end, const MergeSide& y, int j, int j_end) {
+    for (; i < i_end; i++) {
+      int row = x.row(i);
+      for (int k = j; k < j_end; k++) {
+        indices_x.push_back(row);
+        indices_y.push_back(y.row(k));
+      }
+    }
+  }
+
+  inline void unmatched_x(const MergeSide& x, int i, int i_end) {
+    if (!keep_x) return;
+    for (; i < i_end; i++) {
+      indices_x.push_back(x.row(i));
+      indices_y.push_back(-1); // mark NA
+    }
+  }
+
+  inline void unmatched_y(const MergeSide&, int, int) {}
+
+private:
+  std::vector<int>& indices_x;
+  std::vector<int>& indices_y;
+  bool keep_x;
+};
+
+// rows of y without a match, pointing to the right table as in full_join_impl()
+class MergeJoinUnmatchedY {
+public:
+  MergeJoinUnmatchedY(std::vector<int>& indices_x_, std::vector<int>& indices_y_) :
+    indices_x(indices_x_), indices_y(indices_y_)
+  {}
+
+  inline void matched(const MergeSide&, int, int, const MergeSide&, int, int) {}
+
+  inline void unmatched_x(const MergeSide&, int, int) {}
+
+  inline void unmatched_y(const MergeSide& y, int j, int j_end) {
+    for (; j < j_end; j++) {
+      int row = y.row(j);
+      indices_x.push_back(-row - 1);
+      indices_y.push_back(row);
+    }
+  }
+
+private:
+  std::vector<int>& indices_x;
+  std::vector<int>& indices_y;
+};
+
+// flags the rows of x that have a match
+class MergeJoinMatchedX {
+public:
+  MergeJoinMatchedX(std::vector<bool>& matched_x_) : matched_x(matched_x_) {}
+
+  inline void matched(const MergeSide& x, int i, int i_end, const MergeSide&, int, int) {
+    for (; i < i_end; i++) matched_x[x.row(i)] = true;
+  }
+
+  inline void unmatched_x(const MergeSide&, int, int) {}
+
+  inline void unmatched_y(const MergeSide&, int, int) {}
+
+private:
+  std::vector<bool>& matched_x;
+};
+
+// The key index of y, if it is on the keys by_y in any order, it is not a merge join
+// and the keys of x can probe it. index_by_x are then the keys of x in the order of
+// the keys of the index.
+KeyIndex* join_key_index(const DataFrame& x, const DataFrame& y, CharacterVector by_x, CharacterVector by_y,
+                         const std::string& method, SymbolVector& index_by_x) {
+  if (method == "merge") return NULL;
+
+  KeyIndex* index = KeyIndex::get(y);
+  if (index == NULL) return NULL;
+
+  IntegerVector positions = index->positions_in(SymbolVector(by_y));
+  int n = positions.size();
+  if (n == 0) return NULL;
+
+  CharacterVector vars_x(n);
+  for (int i = 0; i < n; i++) {
+    vars_x[i] = by_x[positions[i]];
+  }
+  index_by_x = SymbolVector(vars_x);
+  return index->compatible(x, index_by_x) ? index : NULL;
+}
+
+// Joins the rows of x with the rows of y found in the key index of y, in the order
+// of x. Rows of x without a match get -1 in indices_y if keep_unmatched, and the
+// rows of y with a match are flagged in y_matched unless it is NULL.
+void index_join(const DataFrame& x, const KeyIndex& index, const SymbolVector& by_x, bool na_match,
+                bool keep_unmatched, std::vector<bool>* y_matched,
+                std::vector<int>& indices_x, std::vector<int>& indices_y) {
+  DataFrameJoinVisitors visitors(x, index.get_keys(), by_x, index.get_vars(), false, na_match);
+  JoinHashTable<DataFrameJoinVisitors> table(visitors, index.get_table());
+
+  int n_x = x.nrows();
+  for (int i = 0; i < n_x; i++) {
+    int k = table.find(i);
+    if (k >= 0) {
+      push_back(indices_y, table.begin(k), table.end(k));
+      push_back(indices_x, i, table.count(k));
+      if (y_matched && !(*y_matched)[*table.begin(k)]) {
+        for (const int* it = table.begin(k); it != table.end(k); ++it) {
+          (*y_matched)[*it] = true;
+        }
+      }
+    } else if (keep_unmatched) {
+      indices_y.push_back(-1); // mark NA
+      indices_x.push_back(i);
+    }
+  }
+}
+
+// Flags the rows of x that have a match in the key index of y, returns their number
+int index_match_x(const DataFrame& x, const KeyIndex& index, const SymbolVector& by_x, bool na_match,
+                  std::vector<bool>& matched_x) {
+  DataFrameJoinVisitors visitors(x, index.get_keys(), by_x, index.get_vars(), false, na_match);
+  JoinHashTable<DataFrameJoinVisitors> table(visitors, index.get_table());
+
+  int n_x = x.nrows(), n_matched = 0;
+  for (int i = 0; i < n_x; i++) {
+    if (table.find(i) >= 0) {
+      matched_x[i] = true;
+      n_matched++;
+    }
+  }
+  return n_matched;
+}
+
+// Flags the rows of x (the left table of the visitors) with a key in the smaller y:
+// the keys of y go in a JoinHashSet and x is streamed against it, on several threads
+// for large tables whose join visitors are thread_safe(). The flags follow the rows
+// of x, so there is nothing to sort.
+int match_x_in_y_set(DataFrameJoinVisitors& visitors, int n_x, int n_y, std::vector<bool>& matched_x) {
+  JoinHashSet<DataFrameJoinVisitors> set(visitors);
+  set.build(n_y, true);
+
+  // bytes rather than bits, so that threads write to distinct elements
+  std::vector<char> matched(n_x, 0);
+  int nthreads = visitors.thread_safe() ? get_nthreads(n_x) : 1;
+
+  #pragma omp parallel for num_threads(nthreads) schedule(static)
+  for (int i = 0; i < n_x; i++) {
+    matched[i] = set.contains(i);
+  }
+
+  int n_matched = 0;
+  for (int i = 0; i < n_x; i++) {
+    if (matched[i]) {
+      matched_x[i] = true;
+      n_matched++;
+    }
+  }
+  return n_matched;
+}
+
+// [[Rcpp::export]]
+DataFrame semi_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match,
+                         const std::string& method) {
+  check_by(by_x);
+
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
+  DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), true, na_match);
+
+  int n_x = x.nrows(), n_y = y.nrows();
+
+  // flag the rows in x that match a row in y
+  std::vector<bool> keep(n_x, false);
+  int n_kept = 0;
+
+  SymbolVector index_by_x;
+  KeyIndex* index = join_key_index(x, y, by_x, by_y, method, index_by_x);
+
+  std::vector<int> order_x, order_y;
+  if (index) {
+    n_kept = index_match_x(x, *index, index_by_x, na_match, keep);
+  } else if (prepare_merge_join(visitors, method, n_x, false, n_y, order_x, order_y)) {
+    MergeJoinMatchedX out(keep);
+    merge_join(visitors, MergeSide(n_x, false, order_x), MergeSide(n_y, true, order_y), out);
+    n_kept = std::count(keep.begin(), keep.end(), true);
+  } else if (n_y < n_x) {
+    n_kept = match_x_in_y_set(visitors, n_x, n_y, keep);
+  } else {
+    // train the table in terms of the smaller x
+    Table table(visitors);
+    table.build(n_x, false);
+    std::vector<bool> found(table.size(), false);
+
+    for (int i = 0; i < n_y; i++) {
+      // find the rows in x that match row i from y, each key only once
+      int k = table.find(-i - 1);
+      if (k >= 0 && !found[k]) {
+        found[k] = true;
+        for (const int* it = table.begin(k); it != table.end(k); ++it) {
+          keep[*it] = true;
+        }
+        n_kept += table.count(k);
+      }
+    }
+  }
+
+  // the flags give the indices in the order of x
+  std::vector<int> indices;
+  indices.reserve(n_kept);
+  for (int i = 0; i < n_x; i++) {
+    if (keep[i]) indices.push_back(i);
+  }
 
   const DataFrame& out = subset(x, indices, x.names(), get_class(x));
   strip_index(out);
@@ -194,31 +665,55 @@ DataFrame semi_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, Charact
 }
 
 // [[Rcpp::export]]
-DataFrame anti_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match) {
+DataFrame anti_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, CharacterVector by_y, bool na_match,
+                         const std::string& method) {
   check_by(by_x);
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
   DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), true, na_match);
-  Map map(visitors);
 
-  // train the map in terms of x
-  train_push_back(map, x.nrows());
+  int n_x = x.nrows(), n_y = y.nrows();
 
-  int n_y = y.nrows();
-  // remove the rows in x that match
-  for (int i = 0; i < n_y; i++) {
-    Map::iterator it = map.find(-i - 1);
-    if (it != map.end())
-      map.erase(it);
+  // flag the rows in x that match a row in y
+  std::vector<bool> drop(n_x, false);
+  int n_dropped = 0;
+
+  SymbolVector index_by_x;
+  KeyIndex* index = join_key_index(x, y, by_x, by_y, method, index_by_x);
+
+  std::vector<int> order_x, order_y;
+  if (index) {
+    n_dropped = index_match_x(x, *index, index_by_x, na_match, drop);
+  } else if (prepare_merge_join(visitors, method, n_x, false, n_y, order_x, order_y)) {
+    MergeJoinMatchedX out(drop);
+    merge_join(visitors, MergeSide(n_x, false, order_x), MergeSide(n_y, true, order_y), out);
+    n_dropped = std::count(drop.begin(), drop.end(), true);
+  } else if (n_y < n_x) {
+    n_dropped = match_x_in_y_set(visitors, n_x, n_y, drop);
+  } else {
+    // train the table in terms of the smaller x
+    Table table(visitors);
+    table.build(n_x, false);
+    std::vector<bool> found(table.size(), false);
+
+    for (int i = 0; i < n_y; i++) {
+      int k = table.find(-i - 1);
+      if (k >= 0 && !found[k]) {
+        found[k] = true;
+        for (const int* it = table.begin(k); it != table.end(k); ++it) {
+          drop[*it] = true;
+        }
+        n_dropped += table.count(k);
+      }
+    }
   }
 
-  // collect what's left
+  // collect what's left, in the order of x
   std::vector<int> indices;
-  indices.reserve(map.size());
-  for (Map::iterator it = map.begin(); it != map.end(); ++it)
-    push_back(indices, it->second);
-
-  std::sort(indices.begin(), indices.end());
+  indices.reserve(n_x - n_dropped);
+  for (int i = 0; i < n_x; i++) {
+    if (!drop[i]) indices.push_back(i);
+  }
 
   const DataFrame& out = subset(x, indices, x.names(), get_class(x));
   strip_index(out);
@@ -229,25 +724,53 @@ DataFrame anti_join_impl(DataFrame x, DataFrame y, CharacterVector by_x, Charact
 DataFrame inner_join_impl(DataFrame x, DataFrame y,
                           CharacterVector by_x, CharacterVector by_y,
                           std::string& suffix_x, std::string& suffix_y,
-                          bool na_match) {
+                          bool na_match, const std::string& method) {
   check_by(by_x);
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
   DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), false, na_match);
-  Map map(visitors);
+  Table table(visitors);
 
   int n_x = x.nrows(), n_y = y.nrows();
 
   std::vector<int> indices_x;
   std::vector<int> indices_y;
 
-  train_push_back_right(map, n_y);
-
-  for (int i = 0; i < n_x; i++) {
-    Map::iterator it = map.find(i);
-    if (it != map.end()) {
-      push_back_right(indices_y, it->second);
-      push_back(indices_x, i, it->second.size());
+  SymbolVector index_by_x;
+  KeyIndex* index = join_key_index(x, y, by_x, by_y, method, index_by_x);
+
+  std::vector<int> order_x, order_y;
+  // string keys are read with the R API, which the worker threads can't call
+  int nthreads = visitors.thread_safe() ? get_nthreads(n_x + n_y) : 1;
+  if (index) {
+    index_join(x, *index, index_by_x, na_match, false, NULL, indices_x, indices_y);
+  } else if (prepare_merge_join(visitors, method, n_x, false, n_y, order_x, order_y)) {
+    MergeJoinPairs out(indices_x, indices_y, false);
+    merge_join(visitors, MergeSide(n_x, false, order_x), MergeSide(n_y, true, order_y), out);
+  } else if (nthreads > 1) {
+    partitioned_join(visitors, true, n_x, n_y, false, nthreads, indices_x, indices_y);
+  } else if (n_y > n_x) {
+    // train the table in terms of the smaller x, the output still follows the rows of x
+    std::vector<int> offsets, matches;
+    std::vector<bool> y_matched;
+    match_build_rows(visitors, n_x, false, n_y, offsets, matches, y_matched);
+
+    for (int i = 0; i < n_x; i++) {
+      if (offsets[i + 1] > offsets[i]) {
+        push_back(indices_y, &matches[0] + offsets[i], &matches[0] + offsets[i + 1]);
+        push_back(indices_x, i, offsets[i + 1] - offsets[i]);
+      }
+    }
+  } else {
+    // train the table in terms of y
+    table.build(n_y, true);
+
+    for (int i = 0; i < n_x; i++) {
+      int k = table.find(i);
+      if (k >= 0) {
+        push_back(indices_y, table.begin(k), table.end(k));
+        push_back(indices_x, i, table.count(k));
+      }
     }
   }
 
@@ -263,30 +786,60 @@ DataFrame inner_join_impl(DataFrame x, DataFrame y,
 DataFrame left_join_impl(DataFrame x, DataFrame y,
                          CharacterVector by_x, CharacterVector by_y,
                          std::string& suffix_x, std::string& suffix_y,
-                         bool na_match) {
+                         bool na_match, const std::string& method) {
   check_by(by_x);
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
   DataFrameJoinVisitors visitors(y, x, SymbolVector(by_y), SymbolVector(by_x), false, na_match);
-
-  Map map(visitors);
-
-  // train the map in terms of y
-  train_push_back(map, y.nrows());
+  Table table(visitors);
 
   std::vector<int> indices_x;
   std::vector<int> indices_y;
 
-  int n_x = x.nrows();
-  for (int i = 0; i < n_x; i++) {
-    // find a row in y that matches row i in x
-    Map::iterator it = map.find(-i - 1);
-    if (it != map.end()) {
-      push_back(indices_y,  it->second);
-      push_back(indices_x, i, it->second.size());
-    } else {
-      indices_y.push_back(-1); // mark NA
-      indices_x.push_back(i);
+  int n_x = x.nrows(), n_y = y.nrows();
+
+  SymbolVector index_by_x;
+  KeyIndex* index = join_key_index(x, y, by_x, by_y, method, index_by_x);
+
+  std::vector<int> order_x, order_y;
+  // string keys are read with the R API, which the worker threads can't call
+  int nthreads = visitors.thread_safe() ? get_nthreads(n_x + n_y) : 1;
+  if (index) {
+    index_join(x, *index, index_by_x, na_match, true, NULL, indices_x, indices_y);
+  } else if (prepare_merge_join(visitors, method, n_x, true, n_y, order_x, order_y)) {
+    MergeJoinPairs out(indices_x, indices_y, true);
+    merge_join(visitors, MergeSide(n_x, true, order_x), MergeSide(n_y, false, order_y), out);
+  } else if (nthreads > 1) {
+    partitioned_join(visitors, false, n_x, n_y, true, nthreads, indices_x, indices_y);
+  } else if (n_y > n_x) {
+    // train the table in terms of the smaller x, x is the right table of the visitors
+    std::vector<int> offsets, matches;
+    std::vector<bool> y_matched;
+    match_build_rows(visitors, n_x, true, n_y, offsets, matches, y_matched);
+
+    for (int i = 0; i < n_x; i++) {
+      if (offsets[i + 1] > offsets[i]) {
+        push_back(indices_y, &matches[0] + offsets[i], &matches[0] + offsets[i + 1]);
+        push_back(indices_x, i, offsets[i + 1] - offsets[i]);
+      } else {
+        indices_y.push_back(-1); // mark NA
+        indices_x.push_back(i);
+      }
+    }
+  } else {
+    // train the table in terms of y
+    table.build(n_y, false);
+
+    for (int i = 0; i < n_x; i++) {
+      // find the rows in y that match row i in x
+      int k = table.find(-i - 1);
+      if (k >= 0) {
+        push_back(indices_y, table.begin(k), table.end(k));
+        push_back(indices_x, i, table.count(k));
+      } else {
+        indices_y.push_back(-1); // mark NA
+        indices_x.push_back(i);
+      }
     }
   }
 
@@ -302,29 +855,56 @@ DataFrame left_join_impl(DataFrame x, DataFrame y,
 DataFrame right_join_impl(DataFrame x, DataFrame y,
                           CharacterVector by_x, CharacterVector by_y,
                           std::string& suffix_x, std::string& suffix_y,
-                          bool na_match) {
+                          bool na_match, const std::string& method) {
   check_by(by_x);
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
   DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), false, na_match);
-  Map map(visitors);
-
-  // train the map in terms of x
-  train_push_back(map, x.nrows());
+  Table table(visitors);
 
   std::vector<int> indices_x;
   std::vector<int> indices_y;
 
-  int n_y = y.nrows();
-  for (int i = 0; i < n_y; i++) {
-    // find a row in y that matches row i in x
-    Map::iterator it = map.find(-i - 1);
-    if (it != map.end()) {
-      push_back(indices_x,  it->second);
-      push_back(indices_y, i, it->second.size());
-    } else {
-      indices_x.push_back(-i - 1); // point to the i-th row in the right table
-      indices_y.push_back(i);
+  int n_x = x.nrows(), n_y = y.nrows();
+
+  std::vector<int> order_x, order_y;
+  if (prepare_merge_join(visitors, method, n_x, false, n_y, order_x, order_y)) {
+    // merge in terms of y, then point the rows of y without a match to the right table
+    MergeJoinPairs out(indices_y, indices_x, true);
+    merge_join(visitors, MergeSide(n_y, true, order_y), MergeSide(n_x, false, order_x), out);
+    int n = indices_x.size();
+    for (int i = 0; i < n; i++) {
+      if (indices_x[i] < 0) indices_x[i] = -indices_y[i] - 1;
+    }
+  } else if (n_x > n_y) {
+    // train the table in terms of the smaller y, y is the right table of the visitors
+    std::vector<int> offsets, matches;
+    std::vector<bool> x_matched;
+    match_build_rows(visitors, n_y, true, n_x, offsets, matches, x_matched);
+
+    for (int i = 0; i < n_y; i++) {
+      if (offsets[i + 1] > offsets[i]) {
+        push_back(indices_x, &matches[0] + offsets[i], &matches[0] + offsets[i + 1]);
+        push_back(indices_y, i, offsets[i + 1] - offsets[i]);
+      } else {
+        indices_x.push_back(-i - 1); // point to the i-th row in the right table
+        indices_y.push_back(i);
+      }
+    }
+  } else {
+    // train the table in terms of x
+    table.build(n_x, false);
+
+    for (int i = 0; i < n_y; i++) {
+      // find the rows in x that match row i in y
+      int k = table.find(-i - 1);
+      if (k >= 0) {
+        push_back(indices_x, table.begin(k), table.end(k));
+        push_back(indices_y, i, table.count(k));
+      } else {
+        indices_x.push_back(-i - 1); // point to the i-th row in the right table
+        indices_y.push_back(i);
+      }
     }
   }
   return subset_join(x, y,
@@ -339,43 +919,116 @@ DataFrame right_join_impl(DataFrame x, DataFrame y,
 DataFrame full_join_impl(DataFrame x, DataFrame y,
                          CharacterVector by_x, CharacterVector by_y,
                          std::string& suffix_x, std::string& suffix_y,
-                         bool na_match) {
+                         bool na_match, const std::string& method) {
   check_by(by_x);
 
-  typedef VisitorSetIndexMap<DataFrameJoinVisitors, std::vector<int> > Map;
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
   DataFrameJoinVisitors visitors(y, x, SymbolVector(by_y), SymbolVector(by_x), false, na_match);
-  Map map(visitors);
-
-  // train the map in terms of y
-  train_push_back(map, y.nrows());
+  Table table(visitors);
 
   std::vector<int> indices_x;
   std::vector<int> indices_y;
 
   int n_x = x.nrows(), n_y = y.nrows();
 
-  // get both the matches and the rows from left but not right
+  SymbolVector index_by_x;
+  KeyIndex* index = join_key_index(x, y, by_x, by_y, method, index_by_x);
+  if (index) {
+    // the matches and the rows from left but not right, then the rows from right but not left
+    std::vector<bool> y_matched(n_y, false);
+    index_join(x, *index, index_by_x, na_match, true, &y_matched, indices_x, indices_y);
+    for (int i = 0; i < n_y; i++) {
+      if (!y_matched[i]) {
+        indices_x.push_back(-i - 1);
+        indices_y.push_back(i);
+      }
+    }
+
+    return subset_join(x, y,
+                       indices_x, indices_y,
+                       by_x, by_y,
+                       suffix_x, suffix_y,
+                       get_class(x)
+                      );
+  }
+
+  std::vector<int> order_x, order_y;
+  if (prepare_merge_join(visitors, method, n_x, true, n_y, order_x, order_y)) {
+    MergeSide side_x(n_x, true, order_x), side_y(n_y, false, order_y);
+
+    // the matches and the rows from left but not right, then a second merge
+    // for the rows from right but not left
+    MergeJoinPairs pairs(indices_x, indices_y, true);
+    merge_join(visitors, side_x, side_y, pairs);
+    MergeJoinUnmatchedY unmatched(indices_x, indices_y);
+    merge_join(visitors, side_x, side_y, unmatched);
+
+    return subset_join(x, y,
+                       indices_x, indices_y,
+                       by_x, by_y,
+                       suffix_x, suffix_y,
+                       get_class(x)
+                      );
+  }
+
+  if (n_y > n_x) {
+    // train the table in terms of the smaller x, x is the right table of the visitors
+    std::vector<int> offsets, matches;
+    std::vector<bool> y_matched;
+    match_build_rows(visitors, n_x, true, n_y, offsets, matches, y_matched);
+
+    for (int i = 0; i < n_x; i++) {
+      if (offsets[i + 1] > offsets[i]) {
+        push_back(indices_y, &matches[0] + offsets[i], &matches[0] + offsets[i + 1]);
+        push_back(indices_x, i, offsets[i + 1] - offsets[i]);
+      } else {
+        indices_y.push_back(-1); // mark NA
+        indices_x.push_back(i);
+      }
+    }
+
+    // then the rows from right but not left
+    for (int i = 0; i < n_y; i++) {
+      if (!y_matched[i]) {
+        indices_x.push_back(-i - 1);
+        indices_y.push_back(i);
+      }
+    }
+
+    return subset_join(x, y,
+                       indices_x, indices_y,
+                       by_x, by_y,
+                       suffix_x, suffix_y,
+                       get_class(x)
+                      );
+  }
+
+  // train the table in terms of y
+  table.build(n_y, false);
+
+  // get both the matches and the rows from left but not right,
+  // flagging the rows of y that have a match
+  std::vector<bool> y_matched(n_y, false);
   for (int i = 0; i < n_x; i++) {
-    // find a row in y that matches row i in x
-    Map::iterator it = map.find(-i - 1);
-    if (it != map.end()) {
-      push_back(indices_y,  it->second);
-      push_back(indices_x, i, it->second.size());
+    // find the rows in y that match row i in x
+    int k = table.find(-i - 1);
+    if (k >= 0) {
+      push_back(indices_y, table.begin(k), table.end(k));
+      push_back(indices_x, i, table.count(k));
+      if (!y_matched[*table.begin(k)]) {
+        for (const int* it = table.begin(k); it != table.end(k); ++it) {
+          y_matched[*it] = true;
+        }
+      }
     } else {
       indices_y.push_back(-1); // mark NA
       indices_x.push_back(i);
     }
   }
 
-  // train a new map in terms of x this time
-  DataFrameJoinVisitors visitors2(x, y, SymbolVector(by_x), SymbolVector(by_y), false, na_match);
-  Map map2(visitors2);
-  train_push_back(map2, x.nrows());
-
+  // then the rows from right but not left
   for (int i = 0; i < n_y; i++) {
-    // try to find row in x that matches this row of y
-    Map::iterator it = map2.find(-i - 1);
-    if (it == map2.end()) {
+    if (!y_matched[i]) {
       indices_x.push_back(-i - 1);
       indices_y.push_back(i);
     }
@@ -388,3 +1041,521 @@ DataFrame full_join_impl(DataFrame x, DataFrame y,
                      get_class(x)
                     );
 }
+
+enum AsofDirection { ASOF_BACKWARD, ASOF_FORWARD, ASOF_NEAREST };
+
+AsofDirection asof_direction(const std::string& direction) {
+  if (direction == "backward") return ASOF_BACKWARD;
+  if (direction == "forward") return ASOF_FORWARD;
+  if (direction == "nearest") return ASOF_NEAREST;
+  bad_arg("direction", "must be one of \"backward\", \"forward\" or \"nearest\"");
+}
+
+// The column of an ordered key of an as-of or inequality join
+SEXP asof_column(const DataFrame& data, const SymbolString& name, const char* side) {
+  int indx = SymbolVector(RCPP_GET_NAMES(data)).match(name);
+  if (indx == NA_INTEGER) {
+    stop("'%s' column not found in %s, cannot join", name.get_utf8_cstring(), side);
+  }
+
+  SEXP column = VECTOR_ELT(data, indx - 1);
+  if (Rf_inherits(column, "factor") || (TYPEOF(column) != INTSXP && TYPEOF(column) != REALSXP)) {
+    bad_col(name, "must be a numeric, date or date-time column to join on, not {type}",
+            _["type"] = get_single_class(column));
+  }
+  return column;
+}
+
+// Dates and date-times only join to the same class
+void check_asof_classes(SEXP column_x, SEXP column_y, const SymbolString& name_x, const SymbolString& name_y) {
+  if (Rf_inherits(column_x, "Date") != Rf_inherits(column_y, "Date") ||
+      Rf_inherits(column_x, "POSIXct") != Rf_inherits(column_y, "POSIXct")) {
+    stop(
+      "Can't join on '%s' x '%s' because of incompatible types (%s / %s)",
+      name_x.get_utf8_cstring(), name_y.get_utf8_cstring(),
+      get_single_class(column_x), get_single_class(column_y)
+    );
+  }
+}
+
+class AsofValueLess {
+public:
+  AsofValueLess(const double* values_) : values(values_) {}
+
+  inline bool operator()(int i, int j) const {
+    return values[i] < values[j];
+  }
+
+private:
+  const double* values;
+};
+
+// Position of the value matched by v among the sorted values [begin, end),
+// -1 if there is none within the tolerance. Among equal values, backward takes
+// the last one and forward the first one, nearest prefers backward on ties.
+int asof_match(const double* begin, const double* end, double v,
+               AsofDirection direction, double tolerance) {
+  int n = end - begin;
+  int before = std::upper_bound(begin, end, v) - begin - 1;
+  int after = std::lower_bound(begin, end, v) - begin;
+  if (after == n) after = -1;
+
+  int pos;
+  switch (direction) {
+  case ASOF_BACKWARD:
+    pos = before;
+    break;
+  case ASOF_FORWARD:
+    pos = after;
+    break;
+  default:
+    if (before < 0) pos = after;
+    else if (after < 0) pos = before;
+    else pos = (v - begin[before] <= begin[after] - v) ? before : after;
+    break;
+  }
+
+  if (pos < 0 || std::fabs(v - begin[pos]) > tolerance) return -1;
+  return pos;
+}
+
+// [[Rcpp::export]]
+DataFrame asof_join_impl(DataFrame x, DataFrame y,
+                         CharacterVector by_x, CharacterVector by_y,
+                         CharacterVector on_x, CharacterVector on_y,
+                         const std::string& direction, double tolerance,
+                         std::string& suffix_x, std::string& suffix_y,
+                         bool na_match) {
+  AsofDirection dir = asof_direction(direction);
+  SymbolString name_x = SymbolVector(on_x)[0], name_y = SymbolVector(on_y)[0];
+  SEXP column_x = asof_column(x, name_x, "lhs");
+  SEXP column_y = asof_column(y, name_y, "rhs");
+  check_asof_classes(column_x, column_y, name_x, name_y);
+  NumericVector values_x = as<NumericVector>(column_x);
+  NumericVector values_y = as<NumericVector>(column_y);
+  const double* p_values_y = REAL(values_y);
+
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
+  DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), false, na_match);
+  Table table(visitors);
+
+  int n_x = x.nrows(), n_y = y.nrows();
+
+  // without equality keys, all the rows of y have the same key
+  bool keyed = visitors.size() > 0;
+  int nkeys = n_y > 0;
+  if (keyed) {
+    table.build(n_y, true);
+    nkeys = table.size();
+  }
+
+  // the rows of y with key k, sorted on the ordered key, are rows[offsets[k]]
+  // to rows[offsets[k + 1] - 1], with their values of the ordered key at the
+  // same positions in values. Rows with a missing value never match.
+  std::vector<int> offsets(nkeys + 1), rows;
+  rows.reserve(n_y);
+  offsets[0] = 0;
+  for (int k = 0; k < nkeys; k++) {
+    if (keyed) {
+      for (const int* it = table.begin(k); it != table.end(k); ++it) {
+        if (!ISNAN(p_values_y[*it])) rows.push_back(*it);
+      }
+    } else {
+      for (int j = 0; j < n_y; j++) {
+        if (!ISNAN(p_values_y[j])) rows.push_back(j);
+      }
+    }
+    offsets[k + 1] = rows.size();
+    std::stable_sort(rows.begin() + offsets[k], rows.end(), AsofValueLess(p_values_y));
+  }
+  int n_rows = rows.size();
+  std::vector<double> values(n_rows);
+  for (int p = 0; p < n_rows; p++) {
+    values[p] = p_values_y[rows[p]];
+  }
+
+  // each row of x appears once, with its match in y or NA
+  std::vector<int> indices_x(n_x), indices_y(n_x, -1);
+  for (int i = 0; i < n_x; i++) {
+    indices_x[i] = i;
+
+    double v = values_x[i];
+    if (ISNAN(v)) continue;
+
+    int k = keyed ? table.find(i) : nkeys - 1;
+    if (k < 0 || offsets[k + 1] == offsets[k]) continue;
+
+    const double* begin = &values[0] + offsets[k];
+    const double* end = &values[0] + offsets[k + 1];
+    int pos = asof_match(begin, end, v, dir, tolerance);
+    if (pos >= 0) indices_y[i] = rows[offsets[k] + pos];
+  }
+
+  return subset_join(x, y,
+                     indices_x, indices_y,
+                     by_x, by_y,
+                     suffix_x, suffix_y,
+                     get_class(x)
+                    );
+}
+
+// An inequality between a column of x and a column of y, seen from y:
+// row j of y matches row i of x when values_y[j] op values_x[i]
+class JoinInequality {
+public:
+  enum Op { LT, LE, GT, GE };
+
+  // op_x is the operator as written from x, i.e. x op_x y
+  JoinInequality(const DataFrame& x, const DataFrame& y, const SymbolString& on_x,
+                 const SymbolString& on_y, const std::string& op_x)
+  {
+    SEXP column_x = asof_column(x, on_x, "lhs");
+    SEXP column_y = asof_column(y, on_y, "rhs");
+    check_asof_classes(column_x, column_y, on_x, on_y);
+    values_x = as<NumericVector>(column_x);
+    values_y = as<NumericVector>(column_y);
+
+    if (op_x == "<") op = GT;
+    else if (op_x == "<=") op = GE;
+    else if (op_x == ">") op = LT;
+    else if (op_x == ">=") op = LE;
+    else bad_arg("conditions", "must use one of <, <=, > or >=, not {op}", _["op"] = op_x);
+  }
+
+  inline bool test(double y, double x) const {
+    switch (op) {
+    case LT:
+      return y < x;
+    case LE:
+      return y <= x;
+    case GT:
+      return y > x;
+    default:
+      return y >= x;
+    }
+  }
+
+  // whether the rows of y that match grow with the value of x
+  inline bool ascending() const {
+    return op == LT || op == LE;
+  }
+
+  NumericVector values_x;
+  NumericVector values_y;
+  Op op;
+};
+
+class InequalityLess {
+public:
+  InequalityLess(const NumericVector& values_, bool ascending_) :
+    values(REAL(values_)), ascending(ascending_)
+  {}
+
+  inline bool operator()(int i, int j) const {
+    return ascending ? values[i] < values[j] : values[i] > values[j];
+  }
+
+private:
+  const double* values;
+  bool ascending;
+};
+
+typedef std::multiset< std::pair<double, int> > InequalityActiveSet;
+
+// Sweeps the rows of x and y of one key, both sorted on the first inequality so that
+// the rows of y matching it grow as the rows of x go. Without a second inequality
+// all these rows match, otherwise they are kept ordered on the second inequality
+// and the matches are a range of them. The matches are pushed to pairs_x and pairs_y.
+void inequality_sweep(const JoinInequality& first, const JoinInequality* second,
+                      const std::vector<int>& rows_x, const std::vector<int>& rows_y,
+                      std::vector<int>& pairs_x, std::vector<int>& pairs_y) {
+  const double* first_x = REAL(first.values_x);
+  const double* first_y = REAL(first.values_y);
+  const double* second_x = second ? REAL(second->values_x) : NULL;
+  const double* second_y = second ? REAL(second->values_y) : NULL;
+  int n_x = rows_x.size(), n_y = rows_y.size();
+
+  InequalityActiveSet active;
+  int p = 0;
+  for (int k = 0; k < n_x; k++) {
+    int i = rows_x[k];
+    while (p < n_y && first.test(first_y[rows_y[p]], first_x[i])) {
+      if (second) {
+        active.insert(std::make_pair(second_y[rows_y[p]], rows_y[p]));
+      }
+      p++;
+    }
+
+    if (!second) {
+      for (int q = 0; q < p; q++) {
+        pairs_x.push_back(i);
+        pairs_y.push_back(rows_y[q]);
+      }
+      continue;
+    }
+
+    double v = second_x[i];
+    InequalityActiveSet::const_iterator begin, end;
+    switch (second->op) {
+    case JoinInequality::LT:
+      begin = active.begin();
+      end = active.lower_bound(std::make_pair(v, INT_MIN));
+      break;
+    case JoinInequality::LE:
+      begin = active.begin();
+      end = active.upper_bound(std::make_pair(v, INT_MAX));
+      break;
+    case JoinInequality::GT:
+      begin = active.upper_bound(std::make_pair(v, INT_MAX));
+      end = active.end();
+      break;
+    default:
+      begin = active.lower_bound(std::make_pair(v, INT_MIN));
+      end = active.end();
+      break;
+    }
+    for (; begin != end; ++begin) {
+      pairs_x.push_back(i);
+      pairs_y.push_back(begin->second);
+    }
+  }
+}
+
+// Keeps the rows with no missing value in the inequalities, sorted on the first one
+void inequality_rows(std::vector<int>& rows, const JoinInequality& first, const JoinInequality* second, bool y) {
+  const double* values_first = REAL(y ? first.values_y : first.values_x);
+  const double* values_second = second ? REAL(y ? second->values_y : second->values_x) : NULL;
+
+  int n = 0;
+  for (int k = 0; k < (int)rows.size(); k++) {
+    int row = rows[k];
+    if (ISNAN(values_first[row]) || (values_second && ISNAN(values_second[row]))) continue;
+    rows[n++] = row;
+  }
+  rows.resize(n);
+  std::stable_sort(rows.begin(), rows.end(), InequalityLess(y ? first.values_y : first.values_x, first.ascending()));
+}
+
+// [[Rcpp::export]]
+DataFrame inequality_join_impl(DataFrame x, DataFrame y,
+                               CharacterVector by_x, CharacterVector by_y,
+                               CharacterVector on_x, CharacterVector on_y, CharacterVector ops,
+                               bool keep_unmatched,
+                               std::string& suffix_x, std::string& suffix_y,
+                               bool na_match) {
+  int n_conditions = on_x.size();
+  if (n_conditions < 1 || n_conditions > 2) {
+    bad_arg("conditions", "must be one or two inequalities, not {n}", _["n"] = n_conditions);
+  }
+  std::vector<JoinInequality> conditions;
+  for (int i = 0; i < n_conditions; i++) {
+    conditions.push_back(
+      JoinInequality(x, y, SymbolVector(on_x)[i], SymbolVector(on_y)[i], as<std::string>(ops[i]))
+    );
+  }
+  const JoinInequality& first = conditions[0];
+  const JoinInequality* second = n_conditions == 2 ? &conditions[1] : NULL;
+
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
+  DataFrameJoinVisitors visitors(x, y, SymbolVector(by_x), SymbolVector(by_y), false, na_match);
+  Table table(visitors);
+
+  int n_x = x.nrows(), n_y = y.nrows();
+
+  // the rows of x with each key of y, without equality keys all rows have the same key
+  bool keyed = visitors.size() > 0;
+  int nkeys = 1;
+  std::vector<int> x_offsets, x_rows;
+  if (keyed) {
+    table.build(n_y, true);
+    nkeys = table.size();
+
+    std::vector<int> x_keys(n_x);
+    x_offsets.assign(nkeys + 1, 0);
+    for (int i = 0; i < n_x; i++) {
+      x_keys[i] = table.find(i);
+      if (x_keys[i] >= 0) x_offsets[x_keys[i] + 1]++;
+    }
+    for (int k = 0; k < nkeys; k++) {
+      x_offsets[k + 1] += x_offsets[k];
+    }
+    std::vector<int> pos(x_offsets.begin(), x_offsets.end() - 1);
+    x_rows.resize(x_offsets[nkeys]);
+    for (int i = 0; i < n_x; i++) {
+      if (x_keys[i] >= 0) x_rows[pos[x_keys[i]]++] = i;
+    }
+  }
+
+  std::vector<int> pairs_x, pairs_y;
+  std::vector<int> rows_x, rows_y;
+  for (int k = 0; k < nkeys; k++) {
+    if (keyed) {
+      rows_x.assign(x_rows.begin() + x_offsets[k], x_rows.begin() + x_offsets[k + 1]);
+      rows_y.assign(table.begin(k), table.end(k));
+    } else {
+      rows_x.resize(n_x);
+      for (int i = 0; i < n_x; i++) rows_x[i] = i;
+      rows_y.resize(n_y);
+      for (int j = 0; j < n_y; j++) rows_y[j] = j;
+    }
+    inequality_rows(rows_x, first, second, false);
+    inequality_rows(rows_y, first, second, true);
+    inequality_sweep(first, second, rows_x, rows_y, pairs_x, pairs_y);
+  }
+
+  // lay out the matches in the order of x, with the rows of y in ascending order
+  int n_pairs = pairs_x.size();
+  std::vector<int> offsets(n_x + 1, 0);
+  for (int p = 0; p < n_pairs; p++) {
+    offsets[pairs_x[p] + 1]++;
+  }
+  for (int i = 0; i < n_x; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<int> matches(n_pairs);
+  {
+    std::vector<int> pos(offsets.begin(), offsets.end() - 1);
+    for (int p = 0; p < n_pairs; p++) {
+      matches[pos[pairs_x[p]]++] = pairs_y[p];
+    }
+  }
+
+  std::vector<int> indices_x, indices_y;
+  for (int i = 0; i < n_x; i++) {
+    if (offsets[i + 1] > offsets[i]) {
+      std::sort(matches.begin() + offsets[i], matches.begin() + offsets[i + 1]);
+      push_back(indices_y, &matches[0] + offsets[i], &matches[0] + offsets[i + 1]);
+      push_back(indices_x, i, offsets[i + 1] - offsets[i]);
+    } else if (keep_unmatched) {
+      indices_y.push_back(-1); // mark NA
+      indices_x.push_back(i);
+    }
+  }
+
+  return subset_join(x, y,
+                     indices_x, indices_y,
+                     by_x, by_y,
+                     suffix_x, suffix_y,
+                     get_class(x)
+                    );
+}
+
+// [[Rcpp::export]]
+DataFrame star_join_impl(DataFrame x, List dims, List by_x, List by_y, CharacterVector suffixes, bool na_match) {
+  typedef JoinHashTable<DataFrameJoinVisitors> Table;
+  int n_dims = dims.size();
+  int n_x = x.nrows();
+
+  // the dimension tables stay in place, the visitors refer to them
+  std::vector<DataFrame> frames(n_dims);
+  pointer_vector<DataFrameJoinVisitors> visitors(n_dims);
+  pointer_vector<Table> tables(n_dims);
+
+  // the key of each row of x in the table of each dimension, -1 without a match
+  std::vector< std::vector<int> > keys(n_dims, std::vector<int>(n_x));
+
+  for (int d = 0; d < n_dims; d++) {
+    frames[d] = as<DataFrame>(dims[d]);
+    CharacterVector dim_by_x = by_x[d], dim_by_y = by_y[d];
+    check_by(dim_by_x);
+
+    // the key index of the dimension table when it has one on the keys
+    SymbolVector index_by_x;
+    KeyIndex* index = join_key_index(x, frames[d], dim_by_x, dim_by_y, "auto", index_by_x);
+    if (index) {
+      visitors[d] = new DataFrameJoinVisitors(x, index->get_keys(), index_by_x, index->get_vars(), true, na_match);
+      tables[d] = new Table(*visitors[d], index->get_table());
+    } else {
+      visitors[d] = new DataFrameJoinVisitors(x, frames[d], SymbolVector(dim_by_x), SymbolVector(dim_by_y), true, na_match);
+      tables[d] = new Table(*visitors[d]);
+      tables[d]->build(frames[d].nrows(), true);
+    }
+
+    for (int i = 0; i < n_x; i++) {
+      keys[d][i] = tables[d]->find(i);
+    }
+  }
+
+  // each row of x gives the combinations of its matches, or a row with NA for a
+  // dimension without a match, as successive left joins do
+  double n_out = 0;
+  for (int i = 0; i < n_x; i++) {
+    double n = 1;
+    for (int d = 0; d < n_dims; d++) {
+      if (keys[d][i] >= 0) n *= tables[d]->count(keys[d][i]);
+    }
+    n_out += n;
+  }
+  if (n_out > INT_MAX) {
+    stop("star join would give %.0f rows, more than the %d rows a data frame can have", n_out, INT_MAX);
+  }
+
+  std::vector<int> indices_x((int)n_out);
+  std::vector< std::vector<int> > indices(n_dims, std::vector<int>((int)n_out));
+  std::vector<int> pos(n_dims);
+  int row = 0;
+  for (int i = 0; i < n_x; i++) {
+    std::fill(pos.begin(), pos.end(), 0);
+    while (true) {
+      indices_x[row] = i;
+      for (int d = 0; d < n_dims; d++) {
+        int k = keys[d][i];
+        indices[d][row] = k < 0 ? -1 : tables[d]->begin(k)[pos[d]];
+      }
+      row++;
+
+      // next combination, the last dimension changes first
+      int d = n_dims - 1;
+      for (; d >= 0; d--) {
+        int k = keys[d][i];
+        if (k >= 0 && ++pos[d] < tables[d]->count(k)) break;
+        pos[d] = 0;
+      }
+      if (d < 0) break;
+    }
+  }
+
+  // all the columns of x, then the columns of each dimension table but its keys
+  CharacterVector x_names = x.names();
+  int n_columns = x_names.size();
+  std::vector<CharacterVector> dim_columns(n_dims);
+  for (int d = 0; d < n_dims; d++) {
+    CharacterVector dim_names = frames[d].names(), dim_by_y = by_y[d];
+    IntegerVector is_key = r_match(dim_names, dim_by_y);
+    for (int j = 0; j < dim_names.size(); j++) {
+      if (is_key[j] == NA_INTEGER) dim_columns[d].push_back(dim_names[j]);
+    }
+    n_columns += dim_columns[d].size();
+  }
+
+  List out(n_columns);
+  CharacterVector names(n_columns);
+
+  DataFrameSubsetVisitors visitors_x(x, SymbolVector(x_names));
+  int k = 0;
+  for (; k < visitors_x.size(); k++) {
+    out[k] = visitors_x.get(k)->subset(indices_x);
+    names[k] = x_names[k];
+  }
+
+  for (int d = 0; d < n_dims; d++) {
+    DataFrameSubsetVisitors visitors_dim(frames[d], SymbolVector(dim_columns[d]));
+    for (int j = 0; j < visitors_dim.size(); j++, k++) {
+      // the suffix of the table while the name is taken
+      String name = dim_columns[d][j];
+      while (std::find(names.begin(), names.begin() + k, name.get_sexp()) != names.begin() + k) {
+        name += suffixes[d];
+      }
+
+      out[k] = visitors_dim.get(j)->subset(indices[d]);
+      names[k] = name;
+    }
+  }
+
+  set_class(out, get_class(x));
+  set_rownames(out, (int)n_out);
+  out.names() = names;
+  set_vars(out, get_vars(x));
+
+  return (SEXP)out;
+}
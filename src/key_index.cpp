@@ -0,0 +1,212 @@
+#include "pch.h"
+#include <dplyr/main.h>
+
+#include <tools/encoding.h>
+#include <tools/utils.h>
+
+#include <dplyr/KeyIndex.h>
+#include <dplyr/DataFrameSubsetVisitors.h>
+#include <dplyr/tbl_cpp.h>
+
+#include <dplyr/bad.h>
+
+#include <climits>
+
+using namespace Rcpp;
+using namespace dplyr;
+
+namespace dplyr {
+
+// the tag of the external pointers to a KeyIndex
+SEXP key_index_tag() {
+  static SEXP tag = Rf_install("dplyr_key_index");
+  return tag;
+}
+
+DataFrame key_index_frame(List columns, const SymbolVector& vars, int nrows) {
+  columns.names() = vars.get_vector();
+  set_class(columns, "data.frame");
+  set_rownames(columns, nrows);
+  return (SEXP)columns;
+}
+
+KeyIndex::KeyIndex(const DataFrame& data, const SymbolVector& vars_) :
+  vars(vars_), nrows(data.nrows())
+{
+  int nvars = vars.size();
+  IntegerVector indx = vars.match_in_table(RCPP_GET_NAMES(data));
+
+  List columns_(nvars), keys_(nvars);
+  for (int i = 0; i < nvars; i++) {
+    if (indx[i] == NA_INTEGER) {
+      bad_col(vars[i], "is unknown");
+    }
+    SEXP column = shared_SEXP(VECTOR_ELT(data, indx[i] - 1));
+    columns_[i] = column;
+    keys_[i] = TYPEOF(column) == STRSXP ? (SEXP)reencode_char(column) : column;
+  }
+  columns = columns_;
+  keys = key_index_frame(keys_, vars, nrows);
+
+  DataFrameJoinVisitors visitors(keys, keys, vars, vars, false, true);
+  JoinHashTable<DataFrameJoinVisitors> hash_table(visitors);
+  hash_table.build(nrows, true);
+  table = hash_table.get_data();
+}
+
+KeyIndex* KeyIndex::get(const DataFrame& data) {
+  SEXP ptr = Rf_getAttrib(data, Rf_install("key_index"));
+  if (TYPEOF(ptr) != EXTPTRSXP || R_ExternalPtrTag(ptr) != key_index_tag()) return NULL;
+
+  // NULL after the data frame was serialized
+  KeyIndex* index = static_cast<KeyIndex*>(R_ExternalPtrAddr(ptr));
+  if (index == NULL || !index->valid_for(data)) return NULL;
+  return index;
+}
+
+bool KeyIndex::valid_for(const DataFrame& data) const {
+  if (Rf_length(data) == 0 || data.nrows() != nrows) return false;
+
+  IntegerVector indx = vars.match_in_table(RCPP_GET_NAMES(data));
+  for (int i = 0; i < indx.size(); i++) {
+    if (indx[i] == NA_INTEGER) return false;
+    if (VECTOR_ELT(data, indx[i] - 1) != VECTOR_ELT(columns, i)) return false;
+  }
+  return true;
+}
+
+IntegerVector KeyIndex::positions_in(const SymbolVector& names) const {
+  int nvars = vars.size();
+  if (names.size() != nvars) return IntegerVector(0);
+
+  IntegerVector positions = vars.match_in_table(names.get_vector());
+  for (int i = 0; i < nvars; i++) {
+    if (positions[i] == NA_INTEGER) return IntegerVector(0);
+    positions[i]--;
+  }
+  return positions;
+}
+
+bool KeyIndex::compatible(const DataFrame& data, const SymbolVector& names) const {
+  IntegerVector indx = names.match_in_table(RCPP_GET_NAMES(data));
+  for (int i = 0; i < indx.size(); i++) {
+    if (indx[i] == NA_INTEGER) return false;
+
+    SEXP x = VECTOR_ELT(data, indx[i] - 1);
+    SEXP key = VECTOR_ELT(keys, i);
+    if (TYPEOF(x) != TYPEOF(key)) return false;
+
+    bool factor = Rf_inherits(key, "factor");
+    if (Rf_inherits(x, "factor") != factor) return false;
+    if (factor && !same_levels(x, key)) return false;
+
+    if (Rf_inherits(x, "Date") != Rf_inherits(key, "Date")) return false;
+    if (Rf_inherits(x, "POSIXct") != Rf_inherits(key, "POSIXct")) return false;
+  }
+  return true;
+}
+
+// the values to look up in the key column, converted to its type when that does not
+// change the rows `==` or `%in%` keep: values that can't be equal to a key are dropped.
+// Other values are left as is, compatible() tells whether they can be looked up.
+SEXP key_index_values(SEXP key, SEXP values) {
+  int n = Rf_length(values);
+
+  if (Rf_inherits(key, "factor") && TYPEOF(values) == STRSXP && !OBJECT(values)) {
+    // codes of the levels, as the factor is compared as a character vector
+    SEXP levels = Rf_getAttrib(key, R_LevelsSymbol);
+    IntegerVector matches = Rf_match(levels, values, NA_INTEGER);
+    std::vector<int> codes;
+    codes.reserve(n);
+    for (int i = 0; i < n; i++) {
+      if (STRING_ELT(values, i) == NA_STRING) {
+        codes.push_back(NA_INTEGER);
+      } else if (matches[i] != NA_INTEGER) {
+        codes.push_back(matches[i]);
+      }
+    }
+    IntegerVector out = wrap(codes);
+    Rf_setAttrib(out, R_LevelsSymbol, levels);
+    Rf_setAttrib(out, R_ClassSymbol, Rf_getAttrib(key, R_ClassSymbol));
+    return out;
+  }
+
+  if (TYPEOF(key) == INTSXP && !OBJECT(key) && TYPEOF(values) == REALSXP && !OBJECT(values)) {
+    // only whole numbers can be equal to an integer, and NaN does not match NA
+    const double* p = REAL(values);
+    std::vector<int> ints;
+    ints.reserve(n);
+    for (int i = 0; i < n; i++) {
+      if (R_IsNA(p[i])) {
+        ints.push_back(NA_INTEGER);
+      } else if (!R_IsNaN(p[i]) && std::fabs(p[i]) <= INT_MAX && p[i] == (int)p[i]) {
+        ints.push_back((int)p[i]);
+      }
+    }
+    return wrap(ints);
+  }
+
+  if (TYPEOF(key) == REALSXP && !OBJECT(key) && TYPEOF(values) == INTSXP && !OBJECT(values)) {
+    NumericVector out(no_init(n));
+    for (int i = 0; i < n; i++) {
+      int value = INTEGER(values)[i];
+      out[i] = value == NA_INTEGER ? NA_REAL : value;
+    }
+    return out;
+  }
+
+  return values;
+}
+
+}
+
+// [[Rcpp::export]]
+DataFrame key_index_impl(DataFrame data, const SymbolVector& vars) {
+  XPtr<KeyIndex> index(new KeyIndex(data, vars), true, key_index_tag());
+
+  DataFrame out = shallow_copy(data);
+  out.attr("key_index") = index;
+  return out;
+}
+
+// [[Rcpp::export]]
+SEXP key_index_vars_impl(DataFrame data) {
+  KeyIndex* index = KeyIndex::get(data);
+  if (index == NULL) return R_NilValue;
+  return index->get_vars().get_vector();
+}
+
+// rows of df whose key equals one of the values, NULL if df has no valid index on var
+// [[Rcpp::export]]
+SEXP filter_key_index_impl(DataFrame df, const SymbolVector& var, SEXP values, bool na_match) {
+  KeyIndex* index = KeyIndex::get(df);
+  if (index == NULL || index->positions_in(var).size() == 0) return R_NilValue;
+
+  const SymbolVector& vars = index->get_vars();
+  RObject key_values = key_index_values(VECTOR_ELT(index->get_keys(), 0), values);
+  int n = Rf_length(key_values);
+  DataFrame probe = key_index_frame(List::create(key_values), vars, n);
+  if (n == 0) return subset(df, std::vector<int>(), classes_not_grouped());
+  if (!index->compatible(probe, vars)) return R_NilValue;
+
+  DataFrameJoinVisitors visitors(probe, index->get_keys(), vars, vars, false, na_match);
+  JoinHashTable<DataFrameJoinVisitors> table(visitors, index->get_table());
+
+  // each key once, whatever the number of values equal to it
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    int k = table.find(i);
+    if (k >= 0) keys.push_back(k);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  // the rows in the order of df
+  std::vector<int> indices;
+  for (size_t i = 0; i < keys.size(); i++) {
+    indices.insert(indices.end(), table.begin(keys[i]), table.end(keys[i]));
+  }
+  std::sort(indices.begin(), indices.end());
+
+  return subset(df, indices, classes_not_grouped());
+}
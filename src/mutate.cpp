@@ -34,7 +34,11 @@ SEXP structure_mutate(const NamedListAccumulator<Data>& accumulator,
     res.attr("labels")  = df.attr("labels");
     res.attr("index")  = df.attr("index");
     res.attr("indices") = df.attr("indices");
+    res.attr("group_columns") = df.attr("group_columns");
+    res.attr("group_rows") = df.attr("group_rows");
+    res.attr("group_offsets") = df.attr("group_offsets");
     res.attr("drop") = df.attr("drop");
+    res.attr("ordered_groups") = df.attr("ordered_groups");
     res.attr("group_sizes") = df.attr("group_sizes");
     res.attr("biggest_group_size") = df.attr("biggest_group_size");
   }
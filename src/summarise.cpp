@@ -6,6 +6,7 @@
 #include <tools/Quosure.h>
 
 #include <dplyr/GroupedDataFrame.h>
+#include <dplyr/DataFrameVisitors.h>
 
 #include <dplyr/Result/LazyRowwiseSubsets.h>
 #include <dplyr/Result/GroupedCallReducer.h>
@@ -32,6 +33,33 @@ SEXP validate_unquoted_value(SEXP value, int nrows, const SymbolString& name) {
   return value;
 }
 
+// The rows of a grouped summary follow the sorted labels, so the groups
+// defined by the remaining grouping variables are runs of consecutive rows
+static
+void set_summarised_index(DataFrame out, const SymbolVector& vars) {
+  int nr = out.nrows();
+  DataFrameVisitors visitors(out, vars);
+
+  std::vector<int> starts;
+  for (int i = 0; i < nr; i++) {
+    if (i == 0 || !visitors.equal(i - 1, i)) {
+      starts.push_back(i);
+    }
+  }
+  int ngroups = starts.size();
+
+  IntegerVector rows = no_init(nr);
+  for (int i = 0; i < nr; i++) {
+    rows[i] = i;
+  }
+  IntegerVector offsets = no_init(ngroups + 1);
+  std::copy(starts.begin(), starts.end(), offsets.begin());
+  offsets[ngroups] = nr;
+
+  DataFrame labels = DataFrameSubsetVisitors(out, vars).subset(starts, "data.frame");
+  set_index(out, rows, offsets, labels);
+}
+
 template <typename Data, typename Subsets>
 DataFrame summarise_grouped(const DataFrame& df, const QuosureList& dots) {
   Data gdf(df);
@@ -104,6 +132,10 @@ DataFrame summarise_grouped(const DataFrame& df, const QuosureList& dots) {
     out.attr("drop") = true;
 
     strip_index(out);
+    // unordered groups are not runs of the remaining variables, their index is rebuilt lazily
+    if (Rf_isNull(out.attr("ordered_groups"))) {
+      set_summarised_index(out, vars);
+    }
   } else {
     set_class(out, classes_not_grouped());
     SET_ATTRIB(out, strip_group_attributes(out));
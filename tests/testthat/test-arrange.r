@@ -194,3 +194,81 @@ test_that("can choose to inclue grouping vars", {
   expect_equal(df1, df2)
 })
 
+
+test_that("arrange sorts large numeric, logical and factor columns as the comparison sort does", {
+  set.seed(42)
+  n <- 5000
+  df <- data_frame(
+    i = sample(c(-3:3, NA, .Machine$integer.max, -.Machine$integer.max), n, replace = TRUE),
+    l = sample(c(TRUE, FALSE, NA), n, replace = TRUE),
+    f = factor(sample(c("b", "a", "c", NA), n, replace = TRUE), levels = c("c", "b", "a")),
+    d = sample(c(-Inf, -1.5, -0, 0, 2, Inf, NA, NaN), n, replace = TRUE),
+    id = seq_len(n)
+  )
+
+  # NA before NaN, both last whatever the direction
+  rank_d <- function(x, desc = FALSE) {
+    key <- if (desc) -x else x
+    key[is.na(x)] <- Inf
+    ifelse(is.nan(x), 3, ifelse(is.na(x), 2, 1)) * 1e6 + rank(key, ties.method = "min", na.last = "keep")
+  }
+
+  res <- arrange(df, d, desc(i), l)
+  expected <- order(rank_d(df$d), -df$i, df$l, df$id, na.last = TRUE)
+  expect_equal(res$id, df$id[expected])
+
+  res <- arrange(df, f, desc(d), id)
+  expected <- order(as.integer(df$f), rank_d(df$d, desc = TRUE), df$id, na.last = TRUE)
+  expect_equal(res$id, df$id[expected])
+
+  res <- arrange(df, desc(l), desc(f))
+  expected <- order(-df$l, -as.integer(df$f), df$id, na.last = TRUE)
+  expect_equal(res$id, df$id[expected])
+})
+
+test_that("arrange orders strings as sort() does, or by bytes with dplyr.collation = 'C'", {
+  df <- data_frame(x = c("b", "B", "a", NA, "A", "_", "a", "ab", "Ab", ""), id = 1:10)
+
+  res <- arrange(df, x)
+  expect_equal(res$x, c(sort(df$x), NA))
+  expect_equal(res$id, df$id[order(match(df$x, sort(unique(df$x))), df$id)])
+
+  res <- withr::with_options(list(dplyr.collation = "C"), arrange(df, desc(x)))
+  expect_equal(res$id, df$id[order(df$x, decreasing = TRUE, method = "radix")])
+
+  x <- paste0(sample(c(letters, LETTERS), 3e5, replace = TRUE), sample(1e5, 3e5, replace = TRUE))
+  arrange_c <- function(threads) {
+    withr::with_options(
+      list(dplyr.collation = "C", dplyr.threads = threads),
+      arrange(data_frame(x = x, id = seq_along(x)), x)$id
+    )
+  }
+  expect_equal(arrange_c(4L), arrange_c(1L))
+  expect_equal(arrange_c(1L), order(x, method = "radix"))
+
+  expect_error(
+    withr::with_options(list(dplyr.collation = "fr"), arrange(df, x)),
+    "`dplyr.collation` must be \"locale\" or \"C\"",
+    fixed = TRUE
+  )
+})
+
+test_that("arrange sorts on several threads as on one, data frame columns included", {
+  set.seed(42)
+  n <- 3e5
+  df <- data_frame(
+    z = sample(c(1i, 2i, 1 + 1i, NA), n, replace = TRUE),
+    d = sample(c(1.5, -2, NA), n, replace = TRUE),
+    id = seq_len(n)
+  )
+  df$inner <- data.frame(s = sample(c("b", "a", NA), n, replace = TRUE), i = sample(3L, n, replace = TRUE))
+
+  arrange_threads <- function(threads) {
+    withr::with_options(list(dplyr.threads = threads), arrange(df, inner, desc(z), d)$id)
+  }
+  serial <- arrange_threads(1L)
+  expect_equal(arrange_threads(4L), serial)
+
+  res <- arrange(df, desc(d), z)$id
+  expect_equal(withr::with_options(list(dplyr.threads = 4L), arrange(df, desc(d), z)$id), res)
+})
@@ -342,3 +342,23 @@ test_that("filter fails gracefully on raw columns (#1803)", {
 test_that("`vars` attribute is not added if empty (#2772)", {
   expect_identical(tibble(x = 1:2) %>% filter(x == 1), tibble(x = 1L))
 })
+
+test_that("grouped filter derives the index of the result from the original index", {
+  df <- data_frame(g = c(3, 1, 2, 1, 3, 2, 3), x = 1:7) %>% group_by(g)
+  res <- filter(df, x > 2)
+  regrouped <- group_by(ungroup(res), g)
+
+  expect_identical(attr(res, "labels"), attr(regrouped, "labels"))
+  expect_identical(attr(res, "group_rows"), attr(regrouped, "group_rows"))
+  expect_identical(attr(res, "group_offsets"), attr(regrouped, "group_offsets"))
+  expect_identical(attr(res, "group_sizes"), attr(regrouped, "group_sizes"))
+  expect_identical(attr(res, "biggest_group_size"), attr(regrouped, "biggest_group_size"))
+})
+
+test_that("grouped filter drops the groups that become empty", {
+  df <- data_frame(g = c("a", "b", "c", "b"), x = 1:4) %>% group_by(g)
+  res <- filter(df, g != "b")
+  expect_equal(attr(res, "labels")$g, c("a", "c"))
+  expect_equal(group_size(res), c(1L, 1L))
+  expect_equal(group_index_list(res), list(0L, 1L))
+})
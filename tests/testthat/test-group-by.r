@@ -85,6 +85,56 @@ test_that("group_by orders by groups. #242", {
   expect_equal(attr(df, "labels")$a, sqrt(1:10))
 })
 
+test_that("group_by orders integer, factor and logical groups with NA last", {
+  df <- data_frame(
+    i = c(3L, NA, 1L, 3L, 1L, -2L),
+    f = factor(c("b", "a", NA, "b", "a", "a"), levels = c("b", "a")),
+    l = c(TRUE, NA, FALSE, TRUE, FALSE, NA)
+  )
+  g <- group_by(df, i, f, l)
+  labels <- attr(g, "labels")
+  expect_equal(labels$i, c(-2L, 1L, 1L, 3L, NA))
+  expect_equal(labels$f, factor(c("a", "a", NA, "b", "a"), levels = c("b", "a")))
+  expect_equal(labels$l, c(NA, FALSE, FALSE, TRUE, NA))
+  expect_equal(attr(g, "indices"), list(5L, 4L, 2L, c(0L, 3L), 1L))
+
+  # same groups as the hash based index
+  h <- group_by(mutate(df, i = as.numeric(i)), i, f, l)
+  expect_equal(attr(g, "indices"), attr(h, "indices"))
+  expect_equal(group_size(g), group_size(h))
+})
+
+test_that("group index is stored as flat row ids and offsets, and as indices", {
+  g <- group_by(data_frame(x = c(2, 1, 2, 3, 1)), x)
+  expect_equal(attr(g, "group_rows"), c(1L, 4L, 0L, 2L, 3L))
+  expect_equal(attr(g, "group_offsets"), c(0L, 2L, 4L, 5L))
+  expect_equal(attr(g, "indices"), list(c(1L, 4L), c(0L, 2L), 3L))
+  expect_equal(group_index_list(g), attr(g, "indices"))
+})
+
+test_that("group index is the same with several threads", {
+  df <- data_frame(
+    x = sample(c(sqrt(1:50), NA, NaN), 3e5, replace = TRUE),
+    y = sample(c(letters, NA), 3e5, replace = TRUE),
+    z = sample(c(1e6 + 1:200, NA), 3e5, replace = TRUE)
+  )
+
+  # string keys are hashed on the main thread, the others on several threads
+  for (vars in list(c("x", "y"), c("x", "z"))) {
+    serial <- withr::with_options(list(dplyr.threads = 1L), group_by(df, !!! syms(vars)))
+    parallel <- withr::with_options(list(dplyr.threads = 4L), group_by(df, !!! syms(vars)))
+
+    expect_identical(attr(parallel, "labels"), attr(serial, "labels"))
+    expect_identical(attr(parallel, "group_rows"), attr(serial, "group_rows"))
+    expect_identical(attr(parallel, "group_offsets"), attr(serial, "group_offsets"))
+
+    unordered <- function(threads) {
+      withr::with_options(list(dplyr.threads = threads), grouped_df(df, vars, ordered = FALSE))
+    }
+    expect_identical(attr(unordered(4L), "group_rows"), attr(unordered(1L), "group_rows"))
+  }
+})
+
 test_that("group_by uses the white list", {
   df <- data.frame(times = 1:5)
   df$times <- as.POSIXlt(seq.Date(Sys.Date(), length.out = 5, by = "day"))
@@ -295,3 +345,70 @@ test_that("group_by() does not affect input data (#3028)", {
 
   expect_identical(groups(x), syms(quote(old1)))
 })
+
+test_that("group_by(add = TRUE) refines the existing groups", {
+  df <- data_frame(
+    a = c(2, 1, 2, 1, 2, NA, 1),
+    b = c("y", "x", NA, "x", "y", "x", "z"),
+    c = c(3L, NA, 1L, 2L, 3L, 1L, 2L)
+  )
+  refined <- df %>% group_by(a) %>% group_by(b, c, add = TRUE)
+  direct <- group_by(df, a, b, c)
+
+  expect_equal(group_vars(refined), c("a", "b", "c"))
+  expect_equal(attr(refined, "labels"), attr(direct, "labels"))
+  expect_identical(attr(refined, "group_rows"), attr(direct, "group_rows"))
+  expect_identical(attr(refined, "group_offsets"), attr(direct, "group_offsets"))
+  expect_identical(attr(refined, "group_sizes"), attr(direct, "group_sizes"))
+})
+
+test_that("group_by(add = TRUE) does not refine groups the data no longer has", {
+  df <- data_frame(a = c(1, 1, 2, 2, 3), b = c(1, 2, 1, 2, 1))
+  gdf <- group_by(df, a)
+  gdf$a <- rev(gdf$a)
+
+  refined <- group_by(gdf, b, add = TRUE)
+  direct <- group_by(data_frame(a = rev(df$a), b = df$b), a, b)
+  expect_equal(attr(refined, "labels"), attr(direct, "labels"))
+  expect_identical(attr(refined, "group_rows"), attr(direct, "group_rows"))
+  expect_identical(attr(refined, "group_sizes"), attr(direct, "group_sizes"))
+
+  gdf <- group_by(df, a)
+  gdf$a[1] <- 3
+  refined <- group_by(gdf, b, add = TRUE)
+  direct <- group_by(data_frame(a = c(3, df$a[-1]), b = df$b), a, b)
+  expect_equal(attr(refined, "labels"), attr(direct, "labels"))
+  expect_identical(attr(refined, "group_rows"), attr(direct, "group_rows"))
+})
+
+test_that("unordered groups come in the order of their first appearance", {
+  df <- data_frame(x = c("b", "c", "a", "c", "b"), y = c(2, 1, 1, 3, 2), z = 1:5)
+  g <- grouped_df(df, c("x", "y"), ordered = FALSE)
+
+  expect_equal(attr(g, "labels")$x, c("b", "c", "a", "c"))
+  expect_equal(attr(g, "labels")$y, c(2, 1, 1, 3))
+  expect_equal(group_index_list(g), list(c(0L, 4L), 1L, 2L, 3L))
+
+  res <- summarise(g, z = sum(z))
+  expect_equal(res$z, c(6L, 2L, 3L, 4L))
+  expect_equal(attr(res, "labels")$x, c("b", "c", "a"))
+  expect_equal(group_size(res), c(1L, 2L, 1L))
+
+  # the first group lost its first row, so it now comes last
+  res <- filter(g, z > 1)
+  expect_equal(attr(res, "labels")$x, c("c", "a", "c", "b"))
+  expect_equal(group_index_list(res), list(0L, 1L, 2L, 3L))
+
+  res <- mutate(g, n = n())
+  expect_equal(res$n, c(2L, 1L, 1L, 1L, 2L))
+})
+
+test_that("the dplyr.ordered_groups option controls the order of groups", {
+  df <- data_frame(x = c(3L, 1L, 2L, 1L))
+  g <- withr::with_options(list(dplyr.ordered_groups = FALSE), group_by(df, x))
+  expect_equal(attr(g, "labels")$x, c(3L, 1L, 2L))
+
+  sorted <- group_by(g, x)
+  expect_equal(attr(sorted, "labels")$x, c(1L, 2L, 3L))
+  expect_null(attr(ungroup(g), "ordered_groups"))
+})
@@ -823,6 +823,8 @@ test_that("joins strip group indexes (#1597)", {
 
   expect_stripped <- function(df) {
     expect_null(attr(df, "indices"))
+    expect_null(attr(df, "group_rows"))
+    expect_null(attr(df, "group_offsets"))
     expect_null(attr(df, "group_sizes"))
     expect_null(attr(df, "biggest_group_size"))
     expect_null(attr(df, "labels"))
@@ -898,3 +900,156 @@ test_that("semi- and anti-joins preserve order (#2964)", {
     data_frame(a = 3:1)
   )
 })
+
+test_that("joins match all rows of keys with many duplicates and collisions", {
+  x <- data_frame(k = rep(1:5000, 2), x = seq_len(10000))
+  y <- data_frame(k = c(rep(2500:7500, each = 2), NA), y = seq_len(10003))
+
+  res <- inner_join(x, y, by = "k")
+  expect_equal(nrow(res), 2501 * 4)
+  expect_equal(res$x, rep(x$x[x$k >= 2500], each = 2))
+  expect_equal(res$y, unlist(lapply(x$k[x$k >= 2500], function(k) which(y$k == k))))
+
+  res <- left_join(x, y, by = "k")
+  expect_equal(nrow(res), 2499 * 2 + 2501 * 4)
+  expect_true(all(is.na(res$y[res$k < 2500])))
+
+  expect_equal(semi_join(x, y, by = "k")$x, x$x[x$k >= 2500])
+  expect_equal(anti_join(x, y, by = "k")$x, x$x[x$k < 2500])
+  expect_equal(nrow(full_join(x, y, by = "k")), 2499 * 2 + 2501 * 4 + 2500 * 2 + 1)
+})
+
+test_that("joins give the same rows whichever table is larger", {
+  small <- data_frame(k = c(3L, 1L, NA, 3L, 9L), a = 1:5)
+  large <- data_frame(k = c(rep(1:4, 5), NA), b = 1:21)
+
+  expected_inner <- function(x, y) {
+    ids <- expand.grid(j = seq_len(nrow(y)), i = seq_len(nrow(x)))
+    kx <- x$k[ids$i]
+    ky <- y$k[ids$j]
+    ids[(is.na(kx) & is.na(ky)) | (!is.na(kx) & !is.na(ky) & kx == ky), ]
+  }
+
+  ids <- expected_inner(small, large)
+  res <- inner_join(small, large, by = "k")
+  expect_equal(res$a, small$a[ids$i])
+  expect_equal(res$b, large$b[ids$j])
+
+  ids <- expected_inner(large, small)
+  res <- inner_join(large, small, by = "k")
+  expect_equal(res$b, large$b[ids$i])
+  expect_equal(res$a, small$a[ids$j])
+
+  res <- left_join(small, large, by = "k")
+  expect_equal(res$a, c(rep(1L, 5), rep(2L, 5), 3L, rep(4L, 5), 5L))
+  expect_equal(res$b[res$a == 5L], NA_integer_)
+  expect_equal(res$b[res$a == 3L], 21L)
+
+  res <- right_join(large, small, by = "k")
+  expect_equal(res$a, c(rep(1L, 5), rep(2L, 5), 3L, rep(4L, 5), 5L))
+
+  res <- full_join(small, large, by = "k")
+  expect_equal(nrow(res), 17 + 10)
+  expect_equal(tail(res$b, 10), large$b[large$k %in% c(2L, 4L)])
+})
+
+test_that("joins give the same result with several threads", {
+  x <- data_frame(k = sample(c(1:5e4, NA), 2e5, replace = TRUE), a = 1:2e5)
+  y <- data_frame(k = sample(c(1:6e4, NA), 1e5, replace = TRUE), b = 1:1e5)
+
+  for (join in list(inner_join, left_join)) {
+    serial <- withr::with_options(list(dplyr.threads = 1L), join(x, y, by = "k"))
+    parallel <- withr::with_options(list(dplyr.threads = 4L), join(x, y, by = "k"))
+    expect_identical(parallel, serial)
+
+    serial <- withr::with_options(list(dplyr.threads = 1L), join(y, x, by = "k", na_matches = "never"))
+    parallel <- withr::with_options(list(dplyr.threads = 4L), join(y, x, by = "k", na_matches = "never"))
+    expect_identical(parallel, serial)
+  }
+})
+
+test_that("joins on string keys give the same result with several threads", {
+  x <- data_frame(k = as.character(sample(c(1:5e4, NA), 2e5, replace = TRUE)), a = 1:2e5)
+  y <- data_frame(k = as.character(sample(c(1:6e4, NA), 1e5, replace = TRUE)), b = 1:1e5)
+
+  for (join in list(inner_join, left_join)) {
+    serial <- withr::with_options(list(dplyr.threads = 1L), join(x, y, by = "k"))
+    parallel <- withr::with_options(list(dplyr.threads = 4L), join(x, y, by = "k"))
+    expect_identical(parallel, serial)
+  }
+})
+
+test_that("merge join gives the same rows as the hash join on sorted tables", {
+  x <- data_frame(k = c(1L, 1L, 2L, 4L, 5L, NA, NA), a = 1:7)
+  y <- data_frame(k = c(0, 1, 1, 2, 3, 5, NA), b = 1:7)
+
+  for (join in list(inner_join, left_join, right_join, full_join, semi_join, anti_join)) {
+    for (na_matches in c("na", "never")) {
+      expect_identical(
+        join(x, y, by = "k", na_matches = na_matches, method = "merge"),
+        join(x, y, by = "k", na_matches = na_matches, method = "hash")
+      )
+      expect_identical(
+        join(x, y, by = "k", na_matches = na_matches),
+        join(x, y, by = "k", na_matches = na_matches, method = "hash")
+      )
+    }
+  }
+})
+
+test_that("merge join sorts tables that are not sorted", {
+  x <- data_frame(k1 = c(2, NaN, 1, NA, 2), k2 = c("b", "a", "a", "a", "a"), a = 1:5)
+  y <- data_frame(k1 = c(NA, 2, 1, 2, NaN), k2 = c("a", "a", "a", "a", "a"), b = 1:5)
+
+  res <- inner_join(x, y, by = c("k1", "k2"), method = "merge")
+  expect_equal(res$a, c(3L, 5L, 5L, 4L, 2L))
+  expect_equal(res$b, c(3L, 2L, 4L, 1L, 5L))
+
+  res <- full_join(x, y, by = c("k1", "k2"), method = "merge", na_matches = "never")
+  expect_equal(res$a, c(3L, 5L, 5L, 1L, 4L, 2L, NA, NA))
+  expect_equal(res$b, c(3L, 2L, 4L, NA, NA, NA, 1L, 5L))
+
+  expect_equal(semi_join(x, y, by = c("k1", "k2"), method = "merge")$a, 2:5)
+  expect_equal(anti_join(x, y, by = c("k1", "k2"), method = "merge")$a, 1L)
+})
+
+test_that("full_join keeps the rows of y without a match in their order", {
+  x <- data_frame(k = c(3, 1, 3, NA, 7, 8), a = 1:6)
+  y <- data_frame(k = c(NA, 5, 3, NaN, 2), b = 1:5)
+
+  res <- full_join(x, y, by = "k", method = "hash")
+  expect_equal(res$a, c(1L, 2L, 3L, 4L, 5L, 6L, NA, NA, NA))
+  expect_equal(res$b, c(3L, NA, 3L, 1L, NA, NA, 2L, 4L, 5L))
+
+  res <- full_join(x, y, by = "k", method = "hash", na_matches = "never")
+  expect_equal(res$a, c(1:6, NA, NA, NA, NA))
+  expect_equal(res$b, c(3L, NA, 3L, NA, NA, NA, 1L, 2L, 4L, 5L))
+})
+
+test_that("semi_join and anti_join stream a larger x against the keys of y", {
+  x <- data_frame(k1 = c(1:2e5, NA, NaN), k2 = rep(c("a", "b"), 100001), a = seq_len(200002))
+  y <- data_frame(k1 = c(3, 8, 8, 150001, 2e5 + 1, NA, NaN), k2 = c("b", "b", "b", "b", "a", "a", "b"))
+
+  for (na_matches in c("na", "never")) {
+    matched <- paste(x$k1, x$k2) %in% paste(y$k1, y$k2)
+    if (na_matches == "never") matched <- matched & !is.na(x$k1)
+
+    for (threads in c(1L, 4L)) {
+      withr::with_options(list(dplyr.threads = threads), {
+        expect_equal(semi_join(x, y, by = c("k1", "k2"), na_matches = na_matches), x[matched, ])
+        expect_equal(anti_join(x, y, by = c("k1", "k2"), na_matches = na_matches), x[!matched, ])
+      })
+    }
+  }
+})
+
+test_that("semi_join and anti_join on numeric keys give the same result with several threads", {
+  x <- data_frame(k1 = c(1:2e5, NA, NaN), k2 = rep(1:2, 100001), a = seq_len(200002))
+  y <- data_frame(k1 = c(3, 8, 8, 150001, 2e5 + 1, NA, NaN), k2 = c(2L, 2L, 2L, 2L, 1L, 1L, 2L))
+
+  for (join in list(semi_join, anti_join)) {
+    serial <- withr::with_options(list(dplyr.threads = 1L), join(x, y, by = c("k1", "k2")))
+    parallel <- withr::with_options(list(dplyr.threads = 4L), join(x, y, by = c("k1", "k2")))
+    expect_identical(parallel, serial)
+  }
+})
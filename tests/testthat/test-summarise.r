@@ -987,3 +987,47 @@ test_that("summarise() supports unquoted values", {
   expect_error(summarise(gdf, out = !! 1:5), "must be length 2 (the number of groups)", fixed = TRUE)
   expect_error(summarise(gdf, out = !! env(a = 1)), "unsupported type")
 })
+
+test_that("hybrid summaries agree on sorted and unsorted groups", {
+  df <- data_frame(
+    g = rep(1:3, c(4, 1, 5)),
+    x = c(1.5, NA, 3, -2, 7, 4, 4, NA, 0.5, 10),
+    i = c(1L, NA, 3L, -2L, 7L, 4L, 4L, NA, 5L, 10L)
+  )
+  shuffled <- df[c(10, 1, 5, 3, 8, 2, 9, 4, 7, 6), ]
+
+  summarise_all_hybrid <- function(data) {
+    data %>%
+      group_by(g) %>%
+      summarise(
+        sum = sum(x, na.rm = TRUE), sum_i = sum(i),
+        mean = mean(x, na.rm = TRUE), mean_i = mean(i, na.rm = TRUE),
+        min = min(x, na.rm = TRUE), max = max(i)
+      )
+  }
+
+  expect_equal(summarise_all_hybrid(df), summarise_all_hybrid(shuffled))
+  expect_equal(
+    summarise(df, sum = sum(x, na.rm = TRUE), max = max(i, na.rm = TRUE)),
+    data_frame(sum = 28, max = 10L)
+  )
+})
+
+test_that("summarise() derives the index of the remaining groups from the sorted labels", {
+  df <- data_frame(
+    a = c(2, 1, 2, 1, NA, 2),
+    b = c("x", "y", "x", "x", "y", NA),
+    c = 1:6
+  )
+  res <- df %>% group_by(a, b, c) %>% summarise(n = n())
+  regrouped <- group_by(ungroup(res), a, b)
+
+  expect_equal(attr(res, "labels"), attr(regrouped, "labels"))
+  expect_identical(attr(res, "group_rows"), attr(regrouped, "group_rows"))
+  expect_identical(attr(res, "group_offsets"), attr(regrouped, "group_offsets"))
+  expect_identical(attr(res, "group_sizes"), attr(regrouped, "group_sizes"))
+
+  res <- summarise(res, n = sum(n))
+  expect_equal(group_size(res), c(2L, 2L, 1L))
+  expect_equal(attr(res, "labels")$a, c(1, 2, NA))
+})